@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace archive {
+
+// One-shot LZMA decoder which keeps its probability model between calls,
+// so decoding many blocks in a row doesn't touch the heap after the first one.
+// Output buffer is used as the dictionary, as in 'UnpackLZMA'.
+class LzmaDecoder {
+ public:
+  LzmaDecoder();
+  LzmaDecoder(LzmaDecoder&& other);
+  LzmaDecoder& operator=(LzmaDecoder&& other);
+  ~LzmaDecoder();
+
+  // Same as 'UnpackLZMA', 'src' starts with LZMA properties.
+  std::int64_t Decode(std::span<const char> src, std::span<char> dst);
+
+ private:
+  struct State;
+
+  std::unique_ptr<State> state_;
+};  // class LzmaDecoder
+
+}  // namespace archive
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace archive {
+
+// Incremental LZMA decoder. Input and output are passed by chunks of
+// any size, so only the dictionary has to be kept in memory.
+class LzmaStream {
+ public:
+  LzmaStream();
+  LzmaStream(LzmaStream&& other);
+  LzmaStream& operator=(LzmaStream&& other);
+  ~LzmaStream();
+
+  // Starts a new stream of 'unpacked_size' bytes described 
+  // by properties 'props' (LZMA_PROPS_SIZE bytes).
+  std::int64_t Init(std::span<const char> props, std::uint64_t unpacked_size);
+
+  // Decodes as much as possible from 'src' into 'dst', then advances
+  // them past consumed input and produced output. Leaves 'dst' 
+  // non-empty only when all of 'src' was consumed or stream is finished.
+  std::int64_t Decode(std::span<const char>& src, std::span<char>& dst);
+
+  // Count of bytes produced since 'Init'.
+  std::uint64_t produced() const;
+  // Whether whole stream was decoded.
+  bool finished() const;
+
+ private:
+  struct State;
+
+  std::unique_ptr<State> state_;
+};  // class LzmaStream
+
+}  // namespace archive
@@ -0,0 +1,14 @@
+#pragma once
+// Decoders of CN-patched LZ4 blocks built for different instruction sets.
+
+namespace lz4inv_impl {
+
+// Uses 16-byte copies (SSE2 on x86-64).
+int DecodeGeneric(const char* src, char* dst, int src_size, int dst_size);
+
+#ifdef ARCHIVE_HAS_AVX2
+// Uses 32-byte copies, CPU must support AVX2.
+int DecodeAvx2(const char* src, char* dst, int src_size, int dst_size);
+#endif
+
+}  // namespace lz4inv_impl
@@ -0,0 +1,16 @@
+// Built with AVX2 enabled, see CMakeLists.txt
+#include "decode.h"
+
+#ifdef ARCHIVE_HAS_AVX2
+
+#include "decode_kernel.h"
+
+namespace lz4inv_impl {
+
+int DecodeAvx2(const char* src, char* dst, int src_size, int dst_size) {
+  return Decode<32>(src, dst, src_size, dst_size);
+}
+
+}  // namespace lz4inv_impl
+
+#endif
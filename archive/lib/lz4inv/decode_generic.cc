@@ -0,0 +1,10 @@
+#include "decode.h"
+#include "decode_kernel.h"
+
+namespace lz4inv_impl {
+
+int DecodeGeneric(const char* src, char* dst, int src_size, int dst_size) {
+  return Decode<16>(src, dst, src_size, dst_size);
+}
+
+}  // namespace lz4inv_impl
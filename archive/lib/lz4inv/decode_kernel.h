@@ -0,0 +1,169 @@
+#pragma once
+// LZ4 block decoder for the CN-patched format: token nibbles are swapped
+// (literal length is in the low one) and match offsets are big endian.
+// Included by translation units built for different instruction sets,
+// so everything here must have internal linkage.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <immintrin.h>
+#endif
+
+namespace lz4inv_impl {
+
+namespace {
+
+constexpr std::size_t kMinMatch = 4;
+// chunked copies may write this much past the end of copied range
+constexpr std::size_t kWildMargin = 32;
+
+template<std::size_t Width>
+inline void CopyChunk(char* dst, const char* src) {
+#if defined(__AVX2__)
+  if constexpr (Width == 32) {
+    auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), value);
+    return;
+  }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+  if constexpr (Width == 16) {
+    auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), value);
+    return;
+  }
+#endif
+  std::memcpy(dst, src, Width);
+}
+
+// Copies by 'Width' chunks until 'dst_end' is reached or passed.
+template<std::size_t Width>
+inline void WildCopy(char* dst, const char* src, char* dst_end) {
+  do {
+    CopyChunk<Width>(dst, src);
+    dst += Width;
+    src += Width;
+  } while (dst < dst_end);
+}
+
+// Copies match which may overlap with its destination; needs 'kWildMargin'.
+template<std::size_t Width>
+inline void CopyMatch(char* op, const char* match, std::size_t offset, std::size_t length) {
+  char* end = op + length;
+  // chunk never reads bytes which aren't written yet
+  if (offset >= Width) return WildCopy<Width>(op, match, end);
+  if (offset >= 16) return WildCopy<16>(op, match, end);
+  if (offset >= 8) return WildCopy<8>(op, match, end);
+
+  // repeating pattern shorter than a chunk: write it out once,
+  // then copy from the distance which is its multiple and fits a chunk
+  for (int i = 0; i < 8; ++i) op[i] = match[i];
+  std::size_t distance = offset * ((8 + offset - 1) / offset);
+  if (op + 8 < end) WildCopy<8>(op + 8, op + 8 - distance, end);
+}
+
+inline bool ReadLength(const std::uint8_t*& ip, const std::uint8_t* iend, std::size_t& length) {
+  std::uint8_t add;
+  do {
+    if (ip >= iend) return false;
+    add = *ip++;
+    length += add;
+  } while (add == 255);
+  return true;
+}
+
+// Error code of LZ4_decompress_safe: negated position of input + 1.
+inline int ErrorAt(const char* src, const std::uint8_t* ip) {
+  return -static_cast<int>(reinterpret_cast<const char*>(ip) - src) - 1;
+}
+
+// Same contract as LZ4_decompress_safe: returns count of decoded bytes
+// or negative value on malformed input.
+template<std::size_t Width>
+int Decode(const char* src, char* dst, int src_size, int dst_size) {
+  static_assert(16 <= Width && Width <= kWildMargin);
+
+  auto ip = reinterpret_cast<const std::uint8_t*>(src);
+  auto iend = ip + src_size;
+  char* op = dst;
+  char* oend = dst + dst_size;
+
+  // short sequence with all its wild copies fits before these limits
+  constexpr std::size_t kShortInput = 16 + 2;
+  constexpr std::size_t kShortOutput = 14 + 18;
+
+  while (true) {
+    if (ip >= iend) return ErrorAt(src, ip);
+    unsigned token = *ip++;
+
+    std::size_t literals = token & 0xF;
+    std::size_t length = token >> 4;
+
+    // shortcut for the most common case: up to 14 literals and up to 18 bytes
+    // of match, which is far enough so it can be copied by whole chunks
+    if ((literals != 0xF) && (length != 0xF) && 
+        (static_cast<std::size_t>(iend - ip) >= kShortInput) && 
+        (static_cast<std::size_t>(oend - op) >= kShortOutput)) {
+
+      CopyChunk<16>(op, reinterpret_cast<const char*>(ip));
+      ip += literals;
+      op += literals;
+
+      std::size_t offset = (static_cast<std::size_t>(ip[0]) << 8) | ip[1];
+      const char* match = op - offset;
+      if ((offset >= 8) && (offset <= static_cast<std::size_t>(op - dst))) {
+        ip += 2;
+        CopyChunk<8>(op, match);
+        CopyChunk<8>(op + 8, match + 8);
+        CopyChunk<2>(op + 16, match + 16);
+        op += length + kMinMatch;
+        continue;
+      }
+      // match needs careful copy, literals are already done
+    } else {
+      if (literals == 0xF && !ReadLength(ip, iend, literals)) return ErrorAt(src, ip);
+      if (literals > static_cast<std::size_t>(iend - ip)) return ErrorAt(src, ip);
+      if (literals > static_cast<std::size_t>(oend - op)) return ErrorAt(src, ip);
+
+      auto literals_src = reinterpret_cast<const char*>(ip);
+      if ((literals + Width <= static_cast<std::size_t>(iend - ip)) &&
+          (literals + Width <= static_cast<std::size_t>(oend - op))) {
+        WildCopy<Width>(op, literals_src, op + literals);
+      } else {
+        std::memcpy(op, literals_src, literals);
+      }
+      ip += literals;
+      op += literals;
+
+      // last sequence consists of literals only
+      if (ip == iend) break;
+    }
+
+    if (iend - ip < 2) return ErrorAt(src, ip);
+    std::size_t offset = (static_cast<std::size_t>(ip[0]) << 8) | ip[1];
+    ip += 2;
+
+    if (length == 0xF && !ReadLength(ip, iend, length)) return ErrorAt(src, ip);
+    length += kMinMatch;
+
+    if (offset == 0 || offset > static_cast<std::size_t>(op - dst)) return ErrorAt(src, ip);
+    if (length > static_cast<std::size_t>(oend - op)) return ErrorAt(src, ip);
+
+    const char* match = op - offset;
+    if (length + kWildMargin <= static_cast<std::size_t>(oend - op)) {
+      CopyMatch<Width>(op, match, offset, length);
+    } else {
+      for (std::size_t i = 0; i < length; ++i) op[i] = match[i];
+    }
+    op += length;
+  }
+
+  return static_cast<int>(op - dst);
+}
+
+}  // namespace
+
+}  // namespace lz4inv_impl
@@ -0,0 +1,55 @@
+#include "archive/lzma_decoder.h"
+
+#include "archive/unpack.h"
+#include "lzma/LzmaDec.h"
+#include "lzma_memory.h"
+
+namespace archive {
+
+struct LzmaDecoder::State {
+  lzma_impl::CLzmaDec decoder;
+
+  State() { LzmaDec_Construct(&decoder); }
+  // dictionary is never owned, only probabilities are freed
+  ~State() { LzmaDec_FreeProbs(&decoder, &_impl::LzmaMemoryInterface); }
+};  // struct LzmaDecoder::State
+
+LzmaDecoder::LzmaDecoder() 
+  : state_{std::make_unique<State>()}
+  {}
+
+LzmaDecoder::LzmaDecoder(LzmaDecoder&& other) = default;
+LzmaDecoder& LzmaDecoder::operator=(LzmaDecoder&& other) = default;
+LzmaDecoder::~LzmaDecoder() = default;
+
+std::int64_t LzmaDecoder::Decode(std::span<const char> src, std::span<char> dst) {
+  constexpr std::size_t range_coder_init_size = 5;
+  if (src.size() < LZMA_PROPS_SIZE + range_coder_init_size) return SZ_ERROR_INPUT_EOF;
+
+  auto& decoder = state_->decoder;
+  // reallocates only if 'lc' and 'lp' properties have changed
+  auto code = LzmaDec_AllocateProbs(&decoder, 
+                                    reinterpret_cast<const lzma_impl::Byte*>(src.data()), 
+                                    LZMA_PROPS_SIZE, &_impl::LzmaMemoryInterface);
+  if (code != SZ_OK) return code;
+
+  decoder.dic = reinterpret_cast<lzma_impl::Byte*>(dst.data());
+  decoder.dicBufSize = dst.size();
+  LzmaDec_Init(&decoder);
+
+  std::size_t src_size = src.size() - LZMA_PROPS_SIZE;
+  lzma_impl::ELzmaStatus status;
+  code = LzmaDec_DecodeToDic(&decoder, dst.size(), 
+                             reinterpret_cast<const lzma_impl::Byte*>(src.data()) + LZMA_PROPS_SIZE, 
+                             &src_size, lzma_impl::LZMA_FINISH_END, &status);
+  std::size_t dst_size = decoder.dicPos;
+  decoder.dic = nullptr;
+
+  if (code != SZ_OK) return code;
+  if (status == lzma_impl::LZMA_STATUS_NEEDS_MORE_INPUT) return SZ_ERROR_INPUT_EOF;
+  // stream may end with a mark before filling the whole output
+  if (dst_size != dst.size()) return ErrorUnpackNotAll;
+  return 0;
+}
+
+}  // namespace archive
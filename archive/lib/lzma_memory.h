@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdlib>
+
+#include "lzma/LzmaDec.h"
+
+namespace archive {
+
+namespace _impl {
+
+inline void* LzmaAlloc(lzma_impl::ISzAllocPtr, std::size_t size) {
+  return malloc(size);
+}
+
+inline void LzmaFree(lzma_impl::ISzAllocPtr, void* address) {
+  if (address == nullptr) return;
+  free(address);
+}
+
+inline lzma_impl::ISzAlloc LzmaMemoryInterface { &LzmaAlloc, &LzmaFree };
+
+}  // namespace _impl
+
+}  // namespace archive
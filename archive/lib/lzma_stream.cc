@@ -0,0 +1,91 @@
+#include "archive/lzma_stream.h"
+
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+#include "archive/unpack.h"
+#include "lzma/LzmaDec.h"
+#include "lzma_memory.h"
+
+namespace archive {
+
+// LzmaDec rounds smaller dictionaries up to this size anyway
+constexpr std::uint32_t kMinDictSize = 1 << 12;
+
+struct LzmaStream::State {
+  lzma_impl::CLzmaDec decoder;
+  std::uint64_t unpacked_size = 0;
+  std::uint64_t produced = 0;
+
+  State() { LzmaDec_Construct(&decoder); }
+  ~State() { LzmaDec_Free(&decoder, &_impl::LzmaMemoryInterface); }
+};  // struct LzmaStream::State
+
+LzmaStream::LzmaStream() 
+  : state_{std::make_unique<State>()}
+  {}
+
+LzmaStream::LzmaStream(LzmaStream&& other) = default;
+LzmaStream& LzmaStream::operator=(LzmaStream&& other) = default;
+LzmaStream::~LzmaStream() = default;
+
+std::int64_t LzmaStream::Init(std::span<const char> props, std::uint64_t unpacked_size) {
+  if (props.size() < LZMA_PROPS_SIZE) return SZ_ERROR_INPUT_EOF;
+
+  // matches can't reach before the stream start, so dictionary larger
+  // than the whole output is useless; it's rounded up to a power of two,
+  // so blocks of similar size keep the allocated one
+  lzma_impl::Byte header[LZMA_PROPS_SIZE];
+  std::copy_n(props.data(), LZMA_PROPS_SIZE, reinterpret_cast<char*>(header));
+  std::uint32_t dict_size = header[1] | (header[2] << 8) | (header[3] << 16) | (header[4] << 24);
+  std::uint64_t size_class = std::bit_ceil(std::max<std::uint64_t>(unpacked_size, kMinDictSize));
+  dict_size = std::max<std::uint64_t>(std::min<std::uint64_t>(dict_size, size_class), kMinDictSize);
+  for (int i = 0; i < 4; ++i) header[1 + i] = static_cast<lzma_impl::Byte>(dict_size >> (8 * i));
+
+  // keeps dictionary if it has the same size
+  auto code = LzmaDec_Allocate(&state_->decoder, header, LZMA_PROPS_SIZE, 
+                               &_impl::LzmaMemoryInterface);
+  if (code != SZ_OK) return code;
+
+  LzmaDec_Init(&state_->decoder);
+  state_->unpacked_size = unpacked_size;
+  state_->produced = 0;
+  return 0;
+}
+
+std::int64_t LzmaStream::Decode(std::span<const char>& src, std::span<char>& dst) {
+  while (!dst.empty() && !finished()) {
+    auto left = state_->unpacked_size - state_->produced;
+    std::size_t dst_size = std::min<std::uint64_t>(dst.size(), left);
+    std::size_t src_size = src.size();
+    // stream has no end mark, so it must end exactly at the unpacked size
+    auto finish = (dst_size == left) ? lzma_impl::LZMA_FINISH_END : lzma_impl::LZMA_FINISH_ANY;
+
+    lzma_impl::ELzmaStatus status;
+    auto code = LzmaDec_DecodeToBuf(&state_->decoder, 
+                                    reinterpret_cast<lzma_impl::Byte*>(dst.data()), &dst_size,
+                                    reinterpret_cast<const lzma_impl::Byte*>(src.data()), &src_size,
+                                    finish, &status);
+    src = src.subspan(src_size);
+    dst = dst.subspan(dst_size);
+    state_->produced += dst_size;
+    if (code != SZ_OK) return code;
+
+    if (status == lzma_impl::LZMA_STATUS_FINISHED_WITH_MARK && !finished()) 
+      return ErrorUnpackNotAll;
+    if (status == lzma_impl::LZMA_STATUS_NEEDS_MORE_INPUT) break;
+    if (dst_size == 0 && src_size == 0) break;
+  }
+  return 0;
+}
+
+std::uint64_t LzmaStream::produced() const {
+  return state_->produced;
+}
+
+bool LzmaStream::finished() const {
+  return state_->produced == state_->unpacked_size;
+}
+
+}  // namespace archive
@@ -2,18 +2,30 @@
 
 #include <cstdlib>
 
-#include "lz4inv/lz4.h"
+#include <common/cpu.h>
+
+#include "lz4inv/decode.h"
 
 namespace archive {
 
+using DecodeFn = int(*)(const char*, char*, int, int);
+
+static DecodeFn SelectDecoder() {
+#ifdef ARCHIVE_HAS_AVX2
+  if (common::HasAvx2()) return &lz4inv_impl::DecodeAvx2;
+#endif
+  return &lz4inv_impl::DecodeGeneric;
+}
+
 std::int64_t UnpackLZ4Inv(std::span<const char> src, std::span<char> dst) {
+  static const DecodeFn decode = SelectDecoder();
+
   if (src.size() > INT32_MAX) return ErrorInputTooBig;
   if (dst.size() > INT32_MAX) return ErrorOutputTooBig;
-  auto decomp = lz4inv_impl::LZ4_decompress_safe(src.data(), dst.data(), 
-                                                 src.size(), dst.size());
+  auto decomp = decode(src.data(), dst.data(), src.size(), dst.size());
   if (decomp < 0) return decomp;
-  if (decomp != dst.size()) return ErrorUnpackNotAll;
+  if (static_cast<std::size_t>(decomp) != dst.size()) return ErrorUnpackNotAll;
   return 0;
 }
 
-}  // namespace archive
\ No newline at end of file
+}  // namespace archive
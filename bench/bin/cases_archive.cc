@@ -0,0 +1,59 @@
+#include "runner.h"
+
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <archive/unpack.h>
+
+#include "corpus.h"
+
+namespace bench {
+
+namespace {
+
+using UnpackFn = std::int64_t(*)(std::span<const char>, std::span<char>);
+
+struct BlockCorpus {
+  std::vector<std::string> raw;
+  std::vector<std::string> packed;
+  std::string output;
+};  // struct BlockCorpus
+
+Case BlockCase(std::string name, unity::CompressionType type, UnpackFn unpack, std::uint32_t blocks) {
+  return {std::move(name), [=](std::uint32_t scale) -> Operation {
+    constexpr std::size_t block_size = 128 * 1024;
+
+    auto corpus = std::make_shared<BlockCorpus>();
+    for (std::uint32_t i = 0; i < blocks * scale; ++i) {
+      corpus->raw.push_back(MakeData(block_size, i));
+      corpus->packed.push_back(Pack(type, corpus->raw.back()));
+    }
+    corpus->output.resize(block_size);
+
+    for (std::size_t i = 0; i < corpus->raw.size(); ++i) {
+      auto code = unpack(corpus->packed[i], corpus->output);
+      Check(code == 0 && corpus->output == corpus->raw[i], "block corpus doesn't round trip");
+    }
+
+    return [corpus, unpack](Counters& counters) {
+      for (auto& block : corpus->packed) {
+        auto code = unpack(block, corpus->output);
+        Check(code == 0, "unpack failed");
+        counters.bytes += corpus->output.size();
+        ++counters.items;
+      }
+    };
+  }};
+}
+
+}  // namespace
+
+void AddArchiveCases(Runner& runner) {
+  runner.Add(BlockCase("archive.lz4", unity::CompressionType::LZ4, &archive::UnpackLZ4, 32));
+  runner.Add(BlockCase("archive.lz4inv", unity::CompressionType::LZ4Inv, &archive::UnpackLZ4Inv, 32));
+  runner.Add(BlockCase("archive.lzma", unity::CompressionType::LZMA, &archive::UnpackLZMA, 4));
+}
+
+}  // namespace bench
@@ -0,0 +1,316 @@
+#include "runner.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <common/thread_pool.h>
+#include <unity/file/bundle.h>
+#include <unity/file/asset.h>
+#include <unity/type/array.h>
+#include <unity/type/collection.h>
+#include <unity/type/plan.h>
+#include <unity/type/value.h>
+
+#include "corpus.h"
+
+namespace bench {
+
+namespace {
+
+// Leading fields of the type from 'MakeAsset'.
+UNITY_REGULAR_TYPE(CorpusScript, "MonoBehaviour",
+  (m_Name, NOALIGN, unity::type::String)
+  (m_Value, NOALIGN, unity::type::Int)
+);
+
+struct BundleCorpus {
+  std::vector<BundleFile> files;
+  std::string raw;
+  std::string output;
+};  // struct BundleCorpus
+
+std::shared_ptr<BundleCorpus> MakeBundleCorpus(unity::CompressionType type, std::uint32_t files) {
+  auto corpus = std::make_shared<BundleCorpus>();
+  std::size_t total = 0;
+  for (std::uint32_t i = 0; i < files; ++i) {
+    // mix of small and large files, as in real bundles
+    std::size_t size = (i % 8 == 0) ? 300 * 1024 : 3000 + 1500 * (i % 7);
+    corpus->files.push_back({"CAB-" + std::to_string(i), MakeData(size, i)});
+    total += size;
+  }
+  corpus->raw = MakeBundle(corpus->files, 128 * 1024, type);
+  corpus->output.resize(total);
+  return corpus;
+}
+
+unity::file::Bundle ReadBundle(const BundleCorpus& corpus) {
+  auto bundle = unity::file::Bundle::Read(std::span<const char>{corpus.raw});
+  Check(bundle.has_value(), "bundle is not readable");
+  return std::move(*bundle);
+}
+
+Case BundleReadCase() {
+  return {"bundle.read", [](std::uint32_t scale) -> Operation {
+    auto corpus = MakeBundleCorpus(unity::CompressionType::LZ4, 200 * scale);
+    return [corpus](Counters& counters) {
+      // only headers and block info are parsed, so bytes aren't meaningful
+      auto bundle = ReadBundle(*corpus);
+      counters.items += bundle.file_count;
+    };
+  }};
+}
+
+Case BundleUnpackCase(std::string name, unity::CompressionType type, std::uint32_t files) {
+  return {std::move(name), [=](std::uint32_t scale) -> Operation {
+    auto corpus = MakeBundleCorpus(type, files * scale);
+    auto bundle = std::make_shared<unity::file::Bundle>(ReadBundle(*corpus));
+    return [corpus, bundle](Counters& counters) {
+      std::size_t offset = 0;
+      for (auto& file : corpus->files) {
+        std::span<char> buffer{corpus->output.data(), file.content.size()};
+        auto err = bundle->UnpackData(offset, buffer);
+        Check(!err, "bundle unpack failed");
+        offset += file.content.size();
+        counters.bytes += file.content.size();
+        ++counters.items;
+      }
+    };
+  }};
+}
+
+Case BundleParallelCase() {
+  return {"bundle.unpack_parallel.lz4", [](std::uint32_t scale) -> Operation {
+    auto corpus = MakeBundleCorpus(unity::CompressionType::LZ4, 200 * scale);
+    auto bundle = std::make_shared<unity::file::Bundle>(ReadBundle(*corpus));
+    auto pool = std::make_shared<common::ThreadPool>();
+    return [corpus, bundle, pool](Counters& counters) {
+      auto err = bundle->UnpackData(0, corpus->output, *pool);
+      Check(!err, "parallel bundle unpack failed");
+      counters.bytes += corpus->output.size();
+      counters.items += corpus->files.size();
+    };
+  }};
+}
+
+Case AssetReadCase(std::string name, bool big_endian) {
+  return {std::move(name), [=](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({10000 * scale, 64, 64, big_endian}, 1));
+    return [raw](Counters& counters) {
+      auto asset = unity::file::Asset::Read(std::span<const char>{*raw});
+      Check(asset.has_value(), "asset is not readable");
+      counters.bytes += asset->header.data_offset;
+      counters.items += asset->object_count;
+    };
+  }};
+}
+
+// Header is mostly null-terminated paths, one per external file.
+Case AssetExternalsCase() {
+  return {"asset.read.externals", [](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({16, 64, 20000 * scale, false}, 1));
+    return [raw](Counters& counters) {
+      auto asset = unity::file::Asset::Read(std::span<const char>{*raw});
+      Check(asset.has_value(), "asset is not readable");
+      counters.bytes += asset->header.data_offset;
+      counters.items += asset->externals_count;
+    };
+  }};
+}
+
+// Header with many type trees, as in files with lots of scripts;
+// 'lazy' only skips over trees, which are then never used.
+Case AssetTypesCase(std::string name, bool lazy) {
+  return {std::move(name), [=](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({16, 64, 1, false, 2000 * scale}, 1));
+    return [raw, lazy](Counters& counters) {
+      auto asset = unity::file::Asset::Read(std::span<const char>{*raw}, lazy);
+      Check(asset.has_value(), "asset is not readable");
+      counters.bytes += asset->header.data_offset;
+      counters.items += asset->type_count;
+    };
+  }};
+}
+
+// Mapper verification against the type tree of every type, as done
+// before objects of a type are read.
+Case TypeVerifyCase() {
+  return {"typetree.verify", [](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({16, 64, 1, false, 1}, 1));
+    auto asset = std::make_shared<unity::file::Asset>(
+        *unity::file::Asset::Read(std::span<const char>{*raw}));
+    std::uint32_t repeat = 1000000 * scale;
+    return [raw, asset, repeat](Counters& counters) {
+      auto tree = asset->types[0].tree();
+      std::uint32_t verified = 0;
+      for (std::uint32_t i = 0; i < repeat; ++i) {
+        auto current = tree->begin();
+        verified += CorpusScript::Verify(current, tree->end());
+      }
+      Check(verified == repeat, "type is not verified");
+      counters.items += verified;
+    };
+  }};
+}
+
+// Objects decoded by their type tree without a mapper.
+Case ObjectDecodeCase() {
+  return {"object.decode", [](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({20000 * scale, 256, 1, false}, 1));
+    auto asset = std::make_shared<unity::file::Asset>(
+        *unity::file::Asset::Read(std::span<const char>{*raw}));
+    return [raw, asset](Counters& counters) {
+      auto tree = asset->types[0].tree();
+      for (std::uint32_t i = 0; i < asset->object_count; ++i) {
+        auto object = asset->GetObject(i);
+        auto value = unity::type::ValueTree::Decode(*tree, object, asset->header.endian);
+        Check(value.has_value(), "object is not decoded");
+        counters.bytes += object.size();
+        ++counters.items;
+      }
+    };
+  }};
+}
+
+// Same objects with only 'm_Value' decoded, the name is skipped by its
+// size and the data after the field is never touched.
+Case ObjectProjectCase() {
+  return {"object.project", [](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({20000 * scale, 256, 1, false}, 1));
+    auto asset = std::make_shared<unity::file::Asset>(
+        *unity::file::Asset::Read(std::span<const char>{*raw}));
+    auto tree = asset->types[0].tree();
+    std::string_view paths[] = {"m_Value"};
+    auto plan = std::make_shared<unity::type::ReadPlan>(unity::type::ReadPlan::Project(*tree, paths));
+    Check(!plan->error(), "projection is not compiled");
+    // projected field must be the one full decode gives
+    for (std::uint32_t i = 0; i < std::min<std::uint32_t>(asset->object_count, 16); ++i) {
+      auto object = asset->GetObject(i);
+      auto full = unity::type::ValueTree::Decode(*tree, object, asset->header.endian);
+      auto value = unity::type::ValueTree::Decode(*plan, *tree, object, asset->header.endian);
+      Check(full.has_value() && value.has_value(), "object is not decoded");
+      auto expected = full->Find(full->root(), "m_Value");
+      Check(expected && value->root().items().size() == 1 && value->root().items()[0].i == expected->i,
+            "projected value differs from decoded one");
+    }
+    return [raw, asset, tree, plan](Counters& counters) {
+      for (std::uint32_t i = 0; i < asset->object_count; ++i) {
+        auto object = asset->GetObject(i);
+        auto value = unity::type::ValueTree::Decode(*plan, *tree, object, asset->header.endian);
+        Check(value.has_value(), "object is not decoded");
+        counters.bytes += object.size();
+        ++counters.items;
+      }
+    };
+  }};
+}
+
+// Array<T> payload as stored in object data: count, then values in 'endian' order.
+template<typename T>
+Case ArrayReadCase(std::string name, platform::Endian endian) {
+  return {std::move(name), [=](std::uint32_t scale) -> Operation {
+    using Stored = typename T::Stored;
+    std::int32_t count = 1000000 * scale;
+    auto raw = std::make_shared<std::string>(sizeof(count) + count * sizeof(Stored), '\0');
+    auto put = [&](std::size_t pos, auto value) {
+      if (endian != platform::Endian::N) value = std::byteswap(value);
+      std::memcpy(raw->data() + pos, &value, sizeof(value));
+    };
+    put(0, count);
+    for (std::int32_t i = 0; i < count; ++i) 
+      put(sizeof(count) + i * sizeof(Stored), static_cast<std::uint32_t>(i * 2654435761u));
+    return [raw, endian](Counters& counters) {
+      unity::type::MapReader reader{std::span<const char>{*raw}};
+      unity::type::Array<T> array{reader, endian};
+      Check(reader.position == raw->size(), "array is not read fully");
+      counters.bytes += raw->size();
+      counters.items += array.size;
+    };
+  }};
+}
+
+// "All Texture2D over 1 MB" over a table of many small objects;
+// 'columns' scans ObjectTable, otherwise an array of whole structs.
+Case ObjectSelectCase(std::string name, bool columns) {
+  return {std::move(name), [=](std::uint32_t scale) -> Operation {
+    using Asset = unity::file::Asset;
+    std::uint32_t count = 4000000 * scale;
+    auto table = std::make_shared<Asset::ObjectTable>(count);
+    auto rows = std::make_shared<std::vector<Asset::Object>>(count);
+    std::uint32_t state = 1;
+    for (std::uint32_t i = 0; i < count; ++i) {
+      state = state * 1664525u + 1013904223u;
+      Asset::Object object{};
+      object.path_id = i;
+      object.class_id = static_cast<unity::ClassID>((state >> 8) % 32 == 0 ? 28 : (state >> 16) % 200);
+      object.size = (state >> 4) % (4 << 20);
+      table->Set(i, object);
+      (*rows)[i] = object;
+    }
+    Asset::ObjectFilter filter{unity::ClassID::Texture2D, 1 << 20};
+    auto expected = table->Count(filter);
+
+    return [=](Counters& counters) {
+      std::size_t found = 0;
+      if (columns) {
+        found = table->Count(filter);
+      } else {
+        for (auto& row : *rows) 
+          found += (row.class_id == *filter.class_id) && (row.size >= filter.min_size);
+      }
+      Check(found == expected, "object selection differs");
+      counters.items += count;
+    };
+  }};
+}
+
+// Resolves every object of an asset by path_id in scattered order,
+// as PPtr resolution does; index building is part of the warm up.
+Case FindObjectCase() {
+  return {"asset.find_object", [](std::uint32_t scale) -> Operation {
+    auto raw = std::make_shared<std::string>(MakeAsset({200000 * scale, 8, 1, false}, 1));
+    auto asset = std::make_shared<unity::file::Asset>(
+        *unity::file::Asset::Read(std::span<const char>{*raw}));
+    auto ids = asset->objects.path_ids();
+    auto order = std::make_shared<std::vector<std::int64_t>>();
+    for (std::size_t i = 0; i < ids.size(); ++i) 
+      order->push_back(ids[(i * 7919) % ids.size()]);
+    return [raw, asset, order](Counters& counters) {
+      std::uint64_t found = 0;
+      for (auto path_id : *order) found += asset->FindObject(path_id).has_value();
+      Check(found == order->size(), "object is not found");
+      counters.items += found;
+    };
+  }};
+}
+
+}  // namespace
+
+void AddUnityCases(Runner& runner) {
+  runner.Add(BundleReadCase());
+  runner.Add(BundleUnpackCase("bundle.unpack.lz4", unity::CompressionType::LZ4, 200));
+  runner.Add(BundleUnpackCase("bundle.unpack.lz4inv", unity::CompressionType::LZ4Inv, 200));
+  runner.Add(BundleUnpackCase("bundle.unpack.lzma", unity::CompressionType::LZMA, 20));
+  runner.Add(BundleParallelCase());
+  runner.Add(AssetReadCase("asset.read.le", false));
+  runner.Add(AssetReadCase("asset.read.be", true));
+  runner.Add(AssetExternalsCase());
+  runner.Add(AssetTypesCase("asset.read.types.eager", false));
+  runner.Add(AssetTypesCase("asset.read.types.lazy", true));
+  runner.Add(TypeVerifyCase());
+  runner.Add(ObjectDecodeCase());
+  runner.Add(ObjectProjectCase());
+  runner.Add(ArrayReadCase<unity::type::UInt>("array.read.uint.le", platform::Endian::L));
+  runner.Add(ArrayReadCase<unity::type::UInt>("array.read.uint.be", platform::Endian::B));
+  runner.Add(ArrayReadCase<unity::type::Float>("array.read.float.be", platform::Endian::B));
+  runner.Add(ObjectSelectCase("objects.select.rows", false));
+  runner.Add(ObjectSelectCase("objects.select.columns", true));
+  runner.Add(FindObjectCase());
+}
+
+}  // namespace bench
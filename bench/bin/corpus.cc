@@ -0,0 +1,378 @@
+#include "corpus.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <random>
+
+namespace bench {
+
+namespace {
+
+void PutBytes(std::string& to, std::uint64_t value, int size, bool big_endian) {
+  for (int i = 0; i < size; ++i) {
+    int shift = 8 * (big_endian ? (size - 1 - i) : i);
+    to.push_back(static_cast<char>(value >> shift));
+  }
+}
+
+void PutBE(std::string& to, std::uint64_t value, int size) {
+  PutBytes(to, value, size, true);
+}
+
+void PutString(std::string& to, std::string_view value) {
+  to.append(value);
+  to.push_back('\0');
+}
+
+void AlignTo(std::string& to, std::size_t alignment) {
+  while (to.size() % alignment) to.push_back('\0');
+}
+
+// LZ4 sequence; LZ4Inv swaps token nibbles and stores offset big endian.
+void PutSequence(std::string& to, std::string_view literals, std::size_t offset,
+                 std::size_t match, bool inverse) {
+  auto put_length = [&to](std::size_t length) {
+    for (length -= 15; length >= 255; length -= 255) to.push_back(static_cast<char>(255));
+    to.push_back(static_cast<char>(length));
+  };
+
+  std::size_t lit_code = std::min<std::size_t>(literals.size(), 15);
+  std::size_t match_code = match ? std::min<std::size_t>(match - 4, 15) : 0;
+  auto token = inverse ? (lit_code | (match_code << 4)) : ((lit_code << 4) | match_code);
+  to.push_back(static_cast<char>(token));
+  if (lit_code == 15) put_length(literals.size());
+  to.append(literals);
+  if (match == 0) return;
+
+  PutBytes(to, offset, 2, inverse);
+  if (match_code == 15) put_length(match - 4);
+}
+
+std::uint32_t Load32(const char* ptr) {
+  std::uint32_t value;
+  std::memcpy(&value, ptr, 4);
+  return value;
+}
+
+class RangeEncoder {
+ public:
+  void EncodeBit(std::uint16_t& prob, int bit) {
+    std::uint32_t bound = (range_ >> 11) * prob;
+    if (bit == 0) {
+      range_ = bound;
+      prob += (2048 - prob) >> 5;
+    } else {
+      low_ += bound;
+      range_ -= bound;
+      prob -= prob >> 5;
+    }
+    while (range_ < (1u << 24)) {
+      range_ <<= 8;
+      ShiftLow();
+    }
+  }
+
+  std::string Finish() {
+    for (int i = 0; i < 5; ++i) ShiftLow();
+    return std::move(out_);
+  }
+
+ private:
+  void ShiftLow() {
+    if (static_cast<std::uint32_t>(low_) < 0xFF000000u || (low_ >> 32) != 0) {
+      auto carry = static_cast<std::uint8_t>(low_ >> 32);
+      std::uint8_t temp = cache_;
+      do {
+        out_.push_back(static_cast<char>(temp + carry));
+        temp = 0xFF;
+      } while (--cache_size_ != 0);
+      cache_ = static_cast<std::uint8_t>(low_ >> 24);
+    }
+    ++cache_size_;
+    low_ = (low_ & 0x00FFFFFF) << 8;
+  }
+
+  std::uint64_t low_ = 0;
+  std::uint32_t range_ = 0xFFFFFFFF;
+  std::uint8_t cache_ = 0;
+  std::uint64_t cache_size_ = 1;
+  std::string out_;
+};  // class RangeEncoder
+
+}  // namespace
+
+std::string MakeData(std::size_t size, std::uint32_t seed) {
+  static constexpr std::array<std::string_view, 8> words = {
+    "Texture2D ", "m_Name ", "char_002_amiya ", "skill_icon ",
+    "0123456789 ", "MonoBehaviour ", "m_PathID ", "Assets/Arts/"
+  };
+
+  std::mt19937 rng{seed};
+  std::string ret;
+  ret.reserve(size + 16);
+  while (ret.size() < size) {
+    if (rng() % 4 == 0) {
+      ret.push_back(static_cast<char>(rng()));
+    } else {
+      ret.append(words[rng() % words.size()]);
+    }
+  }
+  ret.resize(size);
+  return ret;
+}
+
+std::string PackLZ4(std::string_view src, bool inverse) {
+  constexpr std::size_t hash_bits = 14;
+  constexpr std::size_t last_literals = 5;
+  constexpr std::size_t match_limit = 12;
+
+  std::vector<std::uint32_t> table(1 << hash_bits, UINT32_MAX);
+  std::string out;
+  std::size_t anchor = 0;
+  std::size_t pos = 0;
+  while (pos + match_limit <= src.size()) {
+    auto sequence = Load32(src.data() + pos);
+    auto& slot = table[(sequence * 2654435761u) >> (32 - hash_bits)];
+    std::size_t ref = slot;
+    slot = static_cast<std::uint32_t>(pos);
+
+    if (ref == UINT32_MAX || pos - ref > 65535 || Load32(src.data() + ref) != sequence) {
+      ++pos;
+      continue;
+    }
+
+    std::size_t length = 4;
+    while (pos + length < src.size() - last_literals && src[ref + length] == src[pos + length])
+      ++length;
+    PutSequence(out, src.substr(anchor, pos - anchor), pos - ref, length, inverse);
+    pos += length;
+    anchor = pos;
+  }
+  PutSequence(out, src.substr(anchor), 0, 0, inverse);
+  return out;
+}
+
+std::string PackLZMA(std::string_view src) {
+  // lc = 3, lp = 0, pb = 2, that's what Unity uses
+  constexpr int lc = 3;
+  constexpr std::uint32_t dict_size = 1 << 16;
+
+  std::vector<std::uint16_t> is_match(16 * 4, 1024);
+  std::vector<std::uint16_t> literal(0x300 << lc, 1024);
+  RangeEncoder encoder;
+
+  std::uint8_t prev = 0;
+  for (std::size_t pos = 0; pos < src.size(); ++pos) {
+    // state is always 0, since there are no matches
+    encoder.EncodeBit(is_match[pos & 3], 0);
+    auto probs = literal.data() + 0x300 * (prev >> (8 - lc));
+    auto byte = static_cast<std::uint8_t>(src[pos]);
+    unsigned symbol = 1;
+    for (int i = 7; i >= 0; --i) {
+      int bit = (byte >> i) & 1;
+      encoder.EncodeBit(probs[symbol], bit);
+      symbol = (symbol << 1) | bit;
+    }
+    prev = byte;
+  }
+
+  std::string out;
+  out.push_back(static_cast<char>((2 * 5 + 0) * 9 + lc));
+  PutBytes(out, dict_size, 4, false);
+  out += encoder.Finish();
+  return out;
+}
+
+std::string Pack(unity::CompressionType type, std::string_view src) {
+  switch (type) {
+   case unity::CompressionType::LZMA:
+    return PackLZMA(src);
+   case unity::CompressionType::LZ4:
+   case unity::CompressionType::LZ4HC:
+    return PackLZ4(src, false);
+   case unity::CompressionType::LZ4Inv:
+    return PackLZ4(src, true);
+   default:
+    return std::string{src};
+  }
+}
+
+std::string MakeBundle(const std::vector<BundleFile>& files,
+                       std::size_t block_size,
+                       unity::CompressionType compression) {
+
+  std::string data;
+  for (auto& file : files) data += file.content;
+
+  std::string block_table;
+  std::string packed;
+  std::uint32_t block_count = 0;
+  for (std::size_t offset = 0; offset < data.size(); offset += block_size) {
+    auto raw = std::string_view{data}.substr(offset, block_size);
+    auto block = Pack(compression, raw);
+    PutBE(block_table, raw.size(), 4);
+    PutBE(block_table, block.size(), 4);
+    PutBE(block_table, static_cast<std::uint16_t>(compression), 2);
+    packed += block;
+    ++block_count;
+  }
+
+  std::string info(16, '\0');  // hash of unpacked data
+  PutBE(info, block_count, 4);
+  info += block_table;
+  PutBE(info, files.size(), 4);
+  std::uint64_t offset = 0;
+  for (auto& file : files) {
+    PutBE(info, offset, 8);
+    PutBE(info, file.content.size(), 8);
+    PutBE(info, 4, 4);
+    PutString(info, file.name);
+    offset += file.content.size();
+  }
+  auto packed_info = PackLZ4(info, false);
+
+  constexpr std::uint32_t flags = static_cast<std::uint32_t>(unity::CompressionType::LZ4) |
+                                  static_cast<std::uint32_t>(unity::ArchiveFlags::BlocksDirInfoCombined);
+  std::string ret;
+  PutString(ret, "UnityFS");
+  PutBE(ret, 6, 4);
+  PutString(ret, "5.x.x");
+  PutString(ret, "2019.4.40f1");
+  auto size_pos = ret.size();
+  PutBE(ret, 0, 8);
+  PutBE(ret, packed_info.size(), 4);
+  PutBE(ret, info.size(), 4);
+  PutBE(ret, flags, 4);
+  ret += packed_info;
+  ret += packed;
+
+  std::string size;
+  PutBE(size, ret.size(), 8);
+  ret.replace(size_pos, 8, size);
+  return ret;
+}
+
+std::string MakeAsset(const AssetShape& shape, std::uint32_t seed) {
+  constexpr std::uint32_t version = 22;
+  bool big = shape.big_endian;
+  auto put = [big](std::string& to, std::uint64_t value, int size) { PutBytes(to, value, size, big); };
+
+  // header is patched after the layout is known
+  std::string out(48, '\0');
+  PutString(out, "2019.4.40f1");
+  put(out, static_cast<std::uint32_t>(unity::TargetPlatform::Android), 4);
+  out.push_back(1);  // enable_typetree
+
+  // types
+  std::string type;
+  put(type, static_cast<std::uint32_t>(unity::ClassID::MonoBehaviour), 4);
+  type.push_back(0);  // is_stripped
+  put(type, 0, 2);  // script_type_index
+  type.append(16, '\x11');  // script_id
+  type.append(16, '\x22');  // old_type_hash
+
+  struct Node { std::uint8_t level; const char* type; const char* name; std::int32_t size;
+                std::uint8_t flags; std::uint32_t meta; };
+  const Node nodes[] = {
+    {0, "MonoBehaviour", "Base", -1, 0, 0},
+    {1, "string", "m_Name", -1, 0, 0x8000},
+    {2, "Array", "Array", -1, 1, 0x4000},
+    {3, "int", "size", 4, 0, 0},
+    {3, "char", "data", 1, 0, 0},
+    {1, "int", "m_Value", 4, 0, 0},
+    {1, "vector", "m_Data", -1, 0, 0},
+    {2, "Array", "Array", -1, 1, 0x4000},
+    {3, "int", "size", 4, 0, 0},
+    {3, "float", "data", 4, 0, 0},
+  };
+  std::string strings;
+  auto intern = [&strings](std::string_view value) {
+    auto pos = strings.find(std::string{value} + '\0');
+    if (pos != std::string::npos && (pos == 0 || strings[pos - 1] == '\0')) return pos;
+    pos = strings.size();
+    PutString(strings, value);
+    return pos;
+  };
+  std::string blob;
+  std::uint32_t index = 0;
+  for (auto& node : nodes) {
+    put(blob, 1, 2);
+    blob.push_back(static_cast<char>(node.level));
+    blob.push_back(static_cast<char>(node.flags));
+    put(blob, intern(node.type), 4);
+    put(blob, intern(node.name), 4);
+    put(blob, static_cast<std::uint32_t>(node.size), 4);
+    put(blob, index++, 4);
+    put(blob, node.meta, 4);
+    put(blob, 0, 8);  // ref_type_hash
+  }
+  put(type, std::size(nodes), 4);
+  put(type, strings.size(), 4);
+  type += blob;
+  type += strings;
+  put(type, 0, 4);  // dependencies
+  put(out, shape.type_count, 4);
+  for (std::uint32_t i = 0; i < shape.type_count; ++i) out += type;
+
+  // object data
+  std::mt19937 rng{seed};
+  std::string data;
+  std::vector<std::pair<std::size_t, std::size_t>> ranges;
+  for (std::uint32_t i = 0; i < shape.object_count; ++i) {
+    AlignTo(data, 8);
+    auto begin = data.size();
+    auto name = "obj_" + std::to_string(i);
+    put(data, name.size(), 4);
+    data += name;
+    AlignTo(data, 4);
+    put(data, rng(), 4);
+    std::uint32_t floats = shape.object_size / 4;
+    put(data, floats, 4);
+    for (std::uint32_t j = 0; j < floats; ++j) put(data, std::bit_cast<std::uint32_t>(j * 0.5f), 4);
+    ranges.emplace_back(begin, data.size() - begin);
+  }
+
+  // objects
+  put(out, shape.object_count, 4);
+  for (std::uint32_t i = 0; i < shape.object_count; ++i) {
+    AlignTo(out, 4);
+    put(out, 1000 + std::uint64_t{i} * 7, 8);  // path_id
+    put(out, ranges[i].first, 8);
+    put(out, ranges[i].second, 4);
+    put(out, 0, 4);  // type_id
+  }
+
+  put(out, 0, 4);  // scripts
+  put(out, shape.externals_count, 4);
+  for (std::uint32_t i = 0; i < shape.externals_count; ++i) {
+    PutString(out, "");
+    out.append(16, static_cast<char>(i));
+    put(out, 0, 4);
+    auto cab = "CAB-" + std::to_string(rng()) + std::to_string(rng());
+    PutString(out, "archive:/" + cab + "/" + cab);
+  }
+  put(out, 0, 4);  // reftypes
+  PutString(out, "");  // user information
+
+  auto meta_size = out.size() - 48;
+  AlignTo(out, 16);
+  auto data_offset = out.size();
+  out += data;
+
+  std::string header;
+  PutBE(header, meta_size, 4);
+  PutBE(header, out.size(), 4);
+  PutBE(header, version, 4);
+  PutBE(header, data_offset, 4);
+  header.push_back(big ? 1 : 0);
+  header.append(3, '\0');
+  PutBE(header, meta_size, 4);
+  PutBE(header, out.size(), 8);
+  PutBE(header, data_offset, 8);
+  PutBE(header, 0, 8);
+  out.replace(0, header.size(), header);
+  return out;
+}
+
+}  // namespace bench
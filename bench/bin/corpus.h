@@ -0,0 +1,47 @@
+#pragma once
+// Deterministic synthetic inputs for benchmarks.
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unity/flags.h>
+
+namespace bench {
+
+// Text-like data with repeated words and some noise, compresses about 3x.
+std::string MakeData(std::size_t size, std::uint32_t seed);
+
+// Greedy LZ4 block encoder; 'inverse' produces CN-patched LZ4Inv blocks.
+std::string PackLZ4(std::string_view src, bool inverse);
+// LZMA block (properties + stream without end mark) with literals only.
+std::string PackLZMA(std::string_view src);
+// Packs with given compression, LZ4HC is packed as LZ4.
+std::string Pack(unity::CompressionType type, std::string_view src);
+
+struct BundleFile {
+  std::string name;
+  std::string content;
+};  // struct BundleFile
+
+// UnityFS bundle with LZ4-packed block info; files are stored one after
+// another and split into 'block_size' blocks of given compression.
+std::string MakeBundle(const std::vector<BundleFile>& files,
+                       std::size_t block_size,
+                       unity::CompressionType compression);
+
+struct AssetShape {
+  std::uint32_t object_count;
+  std::uint32_t object_size;  // approximate, bytes of float array per object
+  std::uint32_t externals_count;
+  bool big_endian;
+  std::uint32_t type_count = 1;  // copies of the type, objects use the first one
+};  // struct AssetShape
+
+// Serialized file of version 22 with MonoBehaviour-like type
+// { string m_Name; int m_Value; vector<float> m_Data } and its TypeTree.
+std::string MakeAsset(const AssetShape& shape, std::uint32_t seed);
+
+}  // namespace bench
@@ -0,0 +1,36 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+#include "runner.h"
+
+static void PrintUsage() {
+  std::fprintf(stderr, 
+    "usage: bench-app [--filter <substring>] [--min-time <seconds>] [--scale <n>] [--json]\n");
+}
+
+int main(int argc, char** argv) {
+  bench::Options options;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--json") {
+      options.json = true;
+    } else if (arg == "--filter" && has_value) {
+      options.filter = argv[++i];
+    } else if (arg == "--min-time" && has_value) {
+      options.min_time = std::atof(argv[++i]);
+    } else if (arg == "--scale" && has_value) {
+      options.scale = std::max(1, std::atoi(argv[++i]));
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+
+  bench::Runner runner;
+  bench::AddArchiveCases(runner);
+  bench::AddUnityCases(runner);
+  return runner.Run(options);
+}
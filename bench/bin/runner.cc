@@ -0,0 +1,135 @@
+#include "runner.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (size == 0) size = 1;
+  if (void* ptr = std::malloc(size)) return ptr;
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace bench {
+
+struct Result {
+  std::string name;
+  std::uint64_t iterations;
+  double seconds;
+  Counters counters;
+  std::uint64_t allocations;
+};  // struct Result
+
+std::uint64_t AllocationCount() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+void Check(bool condition, const std::string& message) {
+  if (condition) return;
+  std::fprintf(stderr, "check failed: %s\n", message.c_str());
+  std::exit(2);
+}
+
+void Runner::Add(Case entry) {
+  cases_.push_back(std::move(entry));
+}
+
+static Result Measure(const std::string& name, Operation& operation, double min_time) {
+  using Clock = std::chrono::steady_clock;
+
+  // warm up caches and lazily created state
+  Counters ignored;
+  operation(ignored);
+
+  Result ret{name, 0, 0.0, {}, 0};
+  auto allocations_before = AllocationCount();
+  auto start = Clock::now();
+  do {
+    operation(ret.counters);
+    ++ret.iterations;
+    ret.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (ret.seconds < min_time);
+  ret.allocations = AllocationCount() - allocations_before;
+  return ret;
+}
+
+static void PrintTable(const std::vector<Result>& results) {
+  std::printf("%-32s %10s %12s %14s %12s\n", "name", "iterations", "MB/s", "items/s", "allocs/op");
+  for (auto& result : results) {
+    std::printf("%-32s %10llu %12.1f %14.0f %12.2f\n",
+                result.name.c_str(),
+                static_cast<unsigned long long>(result.iterations),
+                result.counters.bytes / result.seconds / 1e6,
+                result.counters.items / result.seconds,
+                static_cast<double>(result.allocations) / result.iterations);
+  }
+}
+
+static void PrintJson(const std::vector<Result>& results, const Options& options) {
+  std::printf("{\n  \"scale\": %u,\n  \"benchmarks\": [", options.scale);
+  const char* separator = "\n";
+  for (auto& result : results) {
+    std::printf("%s    {\"name\": \"%s\", \"iterations\": %llu, \"seconds\": %.6f, "
+                "\"bytes\": %llu, \"items\": %llu, \"mb_per_s\": %.3f, "
+                "\"items_per_s\": %.3f, \"allocs_per_op\": %.3f}",
+                separator,
+                result.name.c_str(),
+                static_cast<unsigned long long>(result.iterations),
+                result.seconds,
+                static_cast<unsigned long long>(result.counters.bytes),
+                static_cast<unsigned long long>(result.counters.items),
+                result.counters.bytes / result.seconds / 1e6,
+                result.counters.items / result.seconds,
+                static_cast<double>(result.allocations) / result.iterations);
+    separator = ",\n";
+  }
+  std::printf("\n  ]\n}\n");
+}
+
+int Runner::Run(const Options& options) {
+  std::vector<Result> results;
+  for (auto& entry : cases_) {
+    if (entry.name.find(options.filter) == std::string::npos) continue;
+    if (!options.json) std::fprintf(stderr, "running %s\n", entry.name.c_str());
+    auto operation = entry.setup(options.scale);
+    results.push_back(Measure(entry.name, operation, options.min_time));
+  }
+
+  if (options.json) {
+    PrintJson(results, options);
+  } else {
+    PrintTable(results);
+  }
+  return 0;
+}
+
+}  // namespace bench
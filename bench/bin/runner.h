@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+// Amount of work done by benchmark operations.
+struct Counters {
+  std::uint64_t bytes = 0;
+  std::uint64_t items = 0;
+};  // struct Counters
+
+// Runs one operation, adds processed amounts to 'counters'.
+using Operation = std::function<void(Counters& counters)>;
+
+struct Case {
+  std::string name;
+  // Builds inputs, called only if the case is selected.
+  std::function<Operation(std::uint32_t scale)> setup;
+};  // struct Case
+
+struct Options {
+  std::string filter;
+  double min_time = 0.5;
+  std::uint32_t scale = 1;
+  bool json = false;
+};  // struct Options
+
+// Count of 'operator new' calls made by this process so far.
+std::uint64_t AllocationCount();
+
+// Fails the run with 'message' when 'condition' doesn't hold.
+void Check(bool condition, const std::string& message);
+
+class Runner {
+ public:
+  void Add(Case entry);
+  int Run(const Options& options);
+
+ private:
+  std::vector<Case> cases_;
+};  // class Runner
+
+void AddArchiveCases(Runner& runner);
+void AddUnityCases(Runner& runner);
+
+}  // namespace bench
@@ -0,0 +1,9 @@
+#pragma once
+
+namespace common {
+
+// Whether CPU and OS support AVX2. Kernels built with it are picked
+// at runtime by this check; always false off x86-64.
+bool HasAvx2();
+
+}  // namespace common
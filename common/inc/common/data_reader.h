@@ -7,6 +7,7 @@
 
 #include <common/data_view.h>
 #include <common/math.h>
+#include <common/scan.h>
 
 namespace common {
 
@@ -22,20 +23,41 @@ struct DataReader {
   // of 'to'; 'to' must be a power of 2.
   void AlignTo(std::size_t to);
 
+  // Returns count of bytes after 'position'.
+  std::size_t remaining() const;
+
+  // Checks that next 'size' bytes are within data. Reads aren't checked
+  // on their own: parsers reserve a whole fixed-size record with one
+  // call, then read its fields unchecked.
+  bool Need(std::size_t size) const;
+
+  // Same for 'count' records of 'size' bytes, guards the multiplication.
+  bool Need(std::size_t count, std::size_t size) const;
+
   // Returns current reference, then advances by 'sizeof(T)'.
   template<typename T>
   T& Read();
 
   // Returns current pointer, then continuously advances
-  // by 'sizeof(T)' until 0 is encountered.
+  // by 'sizeof(T)' until 0 or the end of data is encountered.
   template<typename T>
   T* ReadNullTerm(std::size_t& size);
 
   // Returns current pointer, then continuously advances
-  // by 'sizeof(T)' until 0 is encountered.
+  // by 'sizeof(T)' until 0 or the end of data is encountered.
   template<typename T>
   T* ReadNullTerm();
 
+  // Bounded 'ReadNullTerm': returns null and keeps 'position'
+  // when there's no terminator before the end of data.
+  template<typename T>
+  T* TryReadNullTerm(std::size_t& size);
+
+  // Bounded 'ReadNullTerm': returns null and keeps 'position'
+  // when there's no terminator before the end of data.
+  template<typename T>
+  T* TryReadNullTerm();
+
   // Returns current pointer, then advances 'size' times by 'sizeof(T)' 
   template<typename T>
   T* ReadArray(std::size_t size);
@@ -46,6 +68,22 @@ const void* DataReader<From>::current() {
   return reinterpret_cast<const char*>(from.data()) + position;
 }
 
+template<DataView From>
+std::size_t DataReader<From>::remaining() const {
+  std::size_t size = from.size();
+  return position < size ? size - position : 0;
+}
+
+template<DataView From>
+bool DataReader<From>::Need(std::size_t size) const {
+  return size <= remaining();
+}
+
+template<DataView From>
+bool DataReader<From>::Need(std::size_t count, std::size_t size) const {
+  return size == 0 || count <= remaining() / size;
+}
+
 template<DataView From>
 void DataReader<From>::AlignTo(std::size_t to) {
   assert(IsPow2(to));
@@ -67,9 +105,9 @@ template<DataView From>
 template<typename T>
 T* DataReader<From>::ReadNullTerm(std::size_t& size) {
   auto ptr = std::bit_cast<T*, const void*>(current());
-  size = 0;
-  while (ptr[size] != 0) ++size;
-  ++size;  // also consume terminator
+  std::size_t limit = remaining() / sizeof(T);
+  size = FindZero(ptr, limit);
+  if (size < limit) ++size;  // also consume terminator
   position += sizeof(T) * size;
   return ptr;
 }
@@ -81,6 +119,25 @@ T* DataReader<From>::ReadNullTerm() {
   return ReadNullTerm<T>(ignored);
 }
 
+template<DataView From>
+template<typename T>
+T* DataReader<From>::TryReadNullTerm(std::size_t& size) {
+  auto ptr = std::bit_cast<T*, const void*>(current());
+  std::size_t limit = remaining() / sizeof(T);
+  size = FindZero(ptr, limit);
+  if (size == limit) return nullptr;
+  ++size;  // also consume terminator
+  position += sizeof(T) * size;
+  return ptr;
+}
+
+template<DataView From>
+template<typename T>
+T* DataReader<From>::TryReadNullTerm() {
+  std::size_t ignored;
+  return TryReadNullTerm<T>(ignored);
+}
+
 template<DataView From>
 template<typename T>
 T* DataReader<From>::ReadArray(std::size_t size) {
@@ -11,4 +11,14 @@ concept DataView = requires(This& r) {
   { r.size() } -> std::same_as<std::size_t>;
 };  // concept DataView
 
+// Source which doesn't keep all its data in memory. 'Lend' returns
+// optional-like holder of a DataView with range [offset; offset + size),
+// which stays valid while the holder lives.
+template<typename This>
+concept LendingView = requires(This& r, std::size_t offset, std::size_t size) {
+  { r.size() } -> std::same_as<std::size_t>;
+  { static_cast<bool>(r.Lend(offset, size)) };
+  { *r.Lend(offset, size) } -> DataView;
+};  // concept LendingView
+
 }  // namespace common
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace common {
+
+// Fast non-cryptographic 64-bit hash (XXH64). Result doesn't depend on
+// platform or byte order, so it can be persisted between runs.
+std::uint64_t Hash64(std::span<const char> data, std::uint64_t seed = 0);
+
+}  // namespace common
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <type_traits>
+
+namespace common {
+
+// Returns index of the first zero among 'count' elements of 'width' bytes
+// at 'data', or 'count' if there's none. Never reads past the last element.
+// 'width' must be 1, 2, 4 or 8; other sizes need an element-wise loop.
+std::size_t FindZero(const void* data, std::size_t count, std::size_t width);
+
+// Same for typed elements; ones which aren't integers of
+// supported width are compared one by one.
+template<typename T>
+std::size_t FindZero(const T* data, std::size_t count) {
+  if constexpr (std::is_integral_v<T> && std::has_single_bit(sizeof(T)) && sizeof(T) <= 8) {
+    return FindZero(static_cast<const void*>(data), count, sizeof(T));
+  } else {
+    std::size_t ret = 0;
+    while (ret < count && data[ret] != 0) ++ret;
+    return ret;
+  }
+}
+
+}  // namespace common
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace common {
+
+// Fixed set of worker threads executing submitted tasks in FIFO order.
+class ThreadPool {
+ public:
+  using Task = std::move_only_function<void()>;
+
+  // Starts 'threads' workers; 0 means tasks only run when some thread helps.
+  explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  // Enqueues 'task' to be run by some worker.
+  void Submit(Task task);
+
+  // Runs one queued task on the calling thread. Returns false if queue was empty.
+  bool RunPending();
+
+  // Count of worker threads.
+  std::size_t size() const { return workers_.size(); }
+
+ private:
+  void Work(std::stop_token stop);
+
+  std::mutex mutex_;
+  std::condition_variable_any wake_;
+  std::deque<Task> tasks_;
+  std::vector<std::jthread> workers_;
+};  // class ThreadPool
+
+// Set of tasks submitted to a pool which can be waited for together.
+class TaskGroup {
+ public:
+  explicit TaskGroup(ThreadPool& pool) : pool_{pool} {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  ~TaskGroup() { Wait(); }
+
+  // Submits 'task' to the pool as a part of this group.
+  void Run(ThreadPool::Task task);
+
+  // Waits until all tasks of this group finish. Calling thread runs
+  // pending tasks of the pool meanwhile, so waiting from inside
+  // another task of the same pool doesn't deadlock it.
+  void Wait();
+
+ private:
+  ThreadPool& pool_;
+  std::mutex mutex_;
+  std::condition_variable done_;
+  std::size_t pending_ = 0;
+};  // class TaskGroup
+
+}  // namespace common
@@ -0,0 +1,30 @@
+#include "common/cpu.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+# include <intrin.h>
+#endif
+
+namespace common {
+
+static bool DetectAvx2() {
+#if defined(_MSC_VER) && defined(_M_X64)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) return false;
+  __cpuid(info, 1);
+  bool os_saves_ymm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 6) == 6);
+  __cpuidex(info, 7, 0);
+  return os_saves_ymm && (info[1] & (1 << 5));
+#elif defined(__x86_64__)
+  return __builtin_cpu_supports("avx2");
+#else
+  return false;
+#endif
+}
+
+bool HasAvx2() {
+  static const bool ret = DetectAvx2();
+  return ret;
+}
+
+}  // namespace common
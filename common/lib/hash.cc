@@ -0,0 +1,88 @@
+#include "common/hash.h"
+
+#include <bit>
+#include <cstring>
+
+namespace common {
+
+namespace {
+
+constexpr std::uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+constexpr std::uint64_t kPrime3 = 0x165667B19E3779F9ull;
+constexpr std::uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+constexpr std::uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+template<typename T>
+T LoadLE(const char* ptr) {
+  T ret;
+  std::memcpy(&ret, ptr, sizeof(T));
+  if constexpr (std::endian::native == std::endian::big) ret = std::byteswap(ret);
+  return ret;
+}
+
+std::uint64_t Round(std::uint64_t acc, std::uint64_t input) {
+  acc += input * kPrime2;
+  acc = std::rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+std::uint64_t MergeRound(std::uint64_t acc, std::uint64_t value) {
+  acc ^= Round(0, value);
+  return acc * kPrime1 + kPrime4;
+}
+
+}  // namespace
+
+std::uint64_t Hash64(std::span<const char> data, std::uint64_t seed) {
+  const char* ptr = data.data();
+  const char* end = ptr + data.size();
+  std::uint64_t ret;
+
+  if (data.size() >= 32) {
+    std::uint64_t v1 = seed + kPrime1 + kPrime2;
+    std::uint64_t v2 = seed + kPrime2;
+    std::uint64_t v3 = seed;
+    std::uint64_t v4 = seed - kPrime1;
+    do {
+      v1 = Round(v1, LoadLE<std::uint64_t>(ptr));
+      v2 = Round(v2, LoadLE<std::uint64_t>(ptr + 8));
+      v3 = Round(v3, LoadLE<std::uint64_t>(ptr + 16));
+      v4 = Round(v4, LoadLE<std::uint64_t>(ptr + 24));
+      ptr += 32;
+    } while (end - ptr >= 32);
+
+    ret = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+    ret = MergeRound(ret, v1);
+    ret = MergeRound(ret, v2);
+    ret = MergeRound(ret, v3);
+    ret = MergeRound(ret, v4);
+  } else {
+    ret = seed + kPrime5;
+  }
+  ret += data.size();
+
+  for (; end - ptr >= 8; ptr += 8) {
+    ret ^= Round(0, LoadLE<std::uint64_t>(ptr));
+    ret = std::rotl(ret, 27) * kPrime1 + kPrime4;
+  }
+  if (end - ptr >= 4) {
+    ret ^= LoadLE<std::uint32_t>(ptr) * kPrime1;
+    ret = std::rotl(ret, 23) * kPrime2 + kPrime3;
+    ptr += 4;
+  }
+  for (; ptr < end; ++ptr) {
+    ret ^= static_cast<std::uint8_t>(*ptr) * kPrime5;
+    ret = std::rotl(ret, 11) * kPrime1;
+  }
+
+  // avalanche
+  ret ^= ret >> 33;
+  ret *= kPrime2;
+  ret ^= ret >> 29;
+  ret *= kPrime3;
+  ret ^= ret >> 32;
+  return ret;
+}
+
+}  // namespace common
@@ -0,0 +1,30 @@
+#include "common/scan.h"
+
+#include <array>
+#include <bit>
+#include <cassert>
+
+#include "common/cpu.h"
+#include "scan/find_zero.h"
+
+namespace common {
+
+// Kernels indexed by log2 of element width.
+using FindZeroTable = std::array<scan_impl::FindZeroFn, 4>;
+
+static FindZeroTable SelectFindZero() {
+  auto select = &scan_impl::FindZeroGeneric;
+#ifdef COMMON_HAS_AVX2
+  if (HasAvx2()) select = &scan_impl::FindZeroAvx2;
+#endif
+  return {select(1), select(2), select(4), select(8)};
+}
+
+std::size_t FindZero(const void* data, std::size_t count, std::size_t width) {
+  static const FindZeroTable find = SelectFindZero();
+
+  assert(width != 0 && width <= 8 && std::has_single_bit(width));
+  return find[std::countr_zero(width)](static_cast<const char*>(data), count);
+}
+
+}  // namespace common
@@ -0,0 +1,20 @@
+#pragma once
+// Terminator searches built for different instruction sets.
+
+#include <cstddef>
+
+namespace scan_impl {
+
+// Arguments are the same as for 'common::FindZero', minus the width,
+// which is a template parameter of kernels.
+using FindZeroFn = std::size_t(*)(const char* data, std::size_t count);
+
+// Uses 16-byte compares (SSE2 on x86-64), scalar elsewhere.
+FindZeroFn FindZeroGeneric(std::size_t width);
+
+#ifdef COMMON_HAS_AVX2
+// Uses 32-byte compares, CPU must support AVX2.
+FindZeroFn FindZeroAvx2(std::size_t width);
+#endif
+
+}  // namespace scan_impl
@@ -0,0 +1,22 @@
+// Built with AVX2 enabled, see CMakeLists.txt
+#include "find_zero.h"
+
+#ifdef COMMON_HAS_AVX2
+
+#include "find_zero_kernel.h"
+
+namespace scan_impl {
+
+FindZeroFn FindZeroAvx2(std::size_t width) {
+  switch (width) {
+   case 1: return &FindZero<1, 32>;
+   case 2: return &FindZero<2, 32>;
+   case 4: return &FindZero<4, 32>;
+   case 8: return &FindZero<8, 32>;
+  }
+  return nullptr;
+}
+
+}  // namespace scan_impl
+
+#endif
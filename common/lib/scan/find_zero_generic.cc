@@ -0,0 +1,16 @@
+#include "find_zero.h"
+#include "find_zero_kernel.h"
+
+namespace scan_impl {
+
+FindZeroFn FindZeroGeneric(std::size_t width) {
+  switch (width) {
+   case 1: return &FindZero<1, 16>;
+   case 2: return &FindZero<2, 16>;
+   case 4: return &FindZero<4, 16>;
+   case 8: return &FindZero<8, 16>;
+  }
+  return nullptr;
+}
+
+}  // namespace scan_impl
@@ -0,0 +1,89 @@
+#pragma once
+// Bounded search of zero elements: whole vectors are compared bytewise,
+// then byte mask is folded so only elements with all bytes zero remain.
+// find_zero_generic.cc and find_zero_avx2.cc each compile their own copy,
+// which is why it all sits in an anonymous namespace.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <immintrin.h>
+#endif
+
+namespace scan_impl {
+
+namespace {
+
+// Lowest bit of each element of given width in a mask of 64 bytes.
+template<std::size_t Width>
+constexpr std::uint64_t kLeadBits = 
+  (Width == 1) ? ~0ull :
+  (Width == 2) ? 0x5555555555555555ull :
+  (Width == 4) ? 0x1111111111111111ull :
+                 0x0101010101010101ull;
+
+// Keeps bits of elements which have all their bytes set in 'mask'.
+template<std::size_t Width>
+inline std::uint64_t FoldMask(std::uint64_t mask) {
+  if constexpr (Width >= 2) mask &= mask >> 1;
+  if constexpr (Width >= 4) mask &= mask >> 2;
+  if constexpr (Width >= 8) mask &= mask >> 4;
+  return mask & kLeadBits<Width>;
+}
+
+template<std::size_t Width>
+inline bool IsZero(const char* ptr) {
+  char zero[Width] = {};
+  return std::memcmp(ptr, zero, Width) == 0;
+}
+
+template<std::size_t Width>
+std::size_t ScalarTail(const char* data, std::size_t begin, std::size_t count) {
+  for (std::size_t i = begin; i < count; ++i) {
+    if (IsZero<Width>(data + i * Width)) return i;
+  }
+  return count;
+}
+
+// 'Vector' is 16 or 32, the latter needs AVX2.
+template<std::size_t Width, std::size_t Vector>
+inline std::uint64_t ZeroBytes(const char* ptr) {
+#if defined(__AVX2__)
+  if constexpr (Vector == 32) {
+    auto value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+    auto zeros = _mm256_cmpeq_epi8(value, _mm256_setzero_si256());
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(zeros));
+  }
+#endif
+#if defined(__SSE2__) || defined(_M_X64)
+  if constexpr (Vector == 16) {
+    auto value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    auto zeros = _mm_cmpeq_epi8(value, _mm_setzero_si128());
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(zeros));
+  }
+#endif
+  std::uint64_t ret = 0;
+  for (std::size_t i = 0; i < Vector; ++i) 
+    ret |= static_cast<std::uint64_t>(ptr[i] == 0) << i;
+  return ret;
+}
+
+template<std::size_t Width, std::size_t Vector>
+std::size_t FindZero(const char* data, std::size_t count) {
+  static_assert(Vector % Width == 0);
+  constexpr std::size_t per_vector = Vector / Width;
+
+  std::size_t i = 0;
+  for (; i + per_vector <= count; i += per_vector) {
+    auto mask = FoldMask<Width>(ZeroBytes<Width, Vector>(data + i * Width));
+    if (mask != 0) return i + std::countr_zero(mask) / Width;
+  }
+  return ScalarTail<Width>(data, i, count);
+}
+
+}  // namespace
+
+}  // namespace scan_impl
@@ -0,0 +1,79 @@
+#include "common/thread_pool.h"
+
+#include <utility>
+
+namespace common {
+
+ThreadPool::ThreadPool(std::size_t threads) {
+  workers_.reserve(threads);
+  for (std::size_t i = 0; i < threads; ++i)
+    workers_.emplace_back([this](std::stop_token stop) { Work(stop); });
+}
+
+ThreadPool::~ThreadPool() {
+  for (auto& worker : workers_) worker.request_stop();
+  wake_.notify_all();
+  workers_.clear();  // joins
+}
+
+void ThreadPool::Submit(Task task) {
+  {
+    std::lock_guard lock{mutex_};
+    tasks_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::RunPending() {
+  Task task;
+  {
+    std::lock_guard lock{mutex_};
+    if (tasks_.empty()) return false;
+    task = std::move(tasks_.front());
+    tasks_.pop_front();
+  }
+  task();
+  return true;
+}
+
+void ThreadPool::Work(std::stop_token stop) {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock lock{mutex_};
+      if (!wake_.wait(lock, stop, [this] { return !tasks_.empty(); })) return;
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void TaskGroup::Run(ThreadPool::Task task) {
+  {
+    std::lock_guard lock{mutex_};
+    ++pending_;
+  }
+  pool_.Submit([this, task = std::move(task)]() mutable {
+    task();
+    // notify under the lock: waiter may destroy the group right after
+    std::lock_guard lock{mutex_};
+    if (--pending_ == 0) done_.notify_all();
+  });
+}
+
+void TaskGroup::Wait() {
+  while (true) {
+    {
+      std::lock_guard lock{mutex_};
+      if (pending_ == 0) return;
+    }
+    if (pool_.RunPending()) continue;
+
+    std::unique_lock lock{mutex_};
+    done_.wait(lock, [this] { return pending_ == 0; });
+    return;
+  }
+}
+
+}  // namespace common
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <algorithm>
+#include <bit>
+#include <cassert>
 #include <cstring>
+#include <span>
 #include <type_traits>
 
 namespace platform {
@@ -72,17 +76,56 @@ using i64re = ByteOrdered<std::int64_t, Endian::Runtime>;
 template<typename T>
 using RuntimeOrder = ByteOrdered<T, Endian::Runtime>;
 
+namespace _impl {
+
+// Reverses bytes of each of 'count' values of 'width' bytes (2, 4 or 8);
+// 'src' and 'dst' are either the same or don't overlap.
+void SwapBytes(const void* src, void* dst, std::size_t count, std::size_t width);
+
+// Copies 'sizeof(T)' bytes from 'src' to 'dst' in reverse order; sizes
+// of integers are swapped with a single instruction.
+template<typename T>
+void CopyReversed(const char* src, char* dst) {
+  if constexpr (sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8) {
+    using U = std::conditional_t<sizeof(T) == 2, std::uint16_t,
+              std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>;
+    U value;
+    std::memcpy(&value, src, sizeof(T));
+    value = std::byteswap(value);
+    std::memcpy(dst, &value, sizeof(T));
+  } else {
+    std::reverse_copy(src, src + sizeof(T), dst);
+  }
+}
+
+}  // namespace _impl
+
+// Converts values stored in 'from' order to native ones, all at once.
+// 'dst' must have the same size as 'src'.
+template<typename T>
+void ConvertSpan(std::span<const RuntimeOrder<T>> src, std::span<T> dst, Endian from);
+
+// Converts values stored in 'from' order to native ones in place.
+template<typename T>
+void ConvertInPlace(std::span<T> data, Endian from);
+
 template <typename T, Endian E>
 ByteOrdered<T, E>::ByteOrdered(const T& data) {
-  *reinterpret_cast<T*>(raw) = data;
-  if constexpr(!Native) std::reverse(raw, raw + sizeof(T));
+  if constexpr(Native) {
+    *reinterpret_cast<T*>(raw) = data;
+  } else {
+    _impl::CopyReversed<T>(reinterpret_cast<const char*>(&data), raw);
+  }
 }
 
 template<typename T, Endian E>
 ByteOrdered<T, E>::operator T() const {
   alignas(T) char ret[sizeof(T)];
-  *reinterpret_cast<T*>(ret) = *reinterpret_cast<const T*>(raw);
-  if constexpr(!Native) std::reverse(ret, ret + sizeof(T));
+  if constexpr(Native) {
+    *reinterpret_cast<T*>(ret) = *reinterpret_cast<const T*>(raw);
+  } else {
+    _impl::CopyReversed<T>(raw, ret);
+  }
   return *reinterpret_cast<T*>(ret);
 }
 
@@ -91,9 +134,33 @@ T ByteOrdered<T, Endian::Runtime>::get(Endian from) const {
   auto native = (sizeof(T) == 1) || (from == Endian::N);
   
   alignas(T) char ret[sizeof(T)];
-  *reinterpret_cast<T*>(ret) = *reinterpret_cast<const T*>(raw);
-  if (!native) std::reverse(ret, ret + sizeof(T));
+  if (native) {
+    *reinterpret_cast<T*>(ret) = *reinterpret_cast<const T*>(raw);
+  } else {
+    _impl::CopyReversed<T>(raw, ret);
+  }
   return *reinterpret_cast<T*>(ret);
 }
 
+template<typename T>
+void ConvertSpan(std::span<const RuntimeOrder<T>> src, std::span<T> dst, Endian from) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+  assert(src.size() == dst.size());
+  if (src.empty()) return;
+  if (sizeof(T) == 1 || from == Endian::N) {
+    std::memcpy(dst.data(), src.data(), src.size_bytes());
+  } else {
+    _impl::SwapBytes(src.data(), dst.data(), src.size(), sizeof(T));
+  }
+}
+
+template<typename T>
+void ConvertInPlace(std::span<T> data, Endian from) {
+  static_assert(std::is_trivially_copyable_v<T>);
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+  if (sizeof(T) == 1 || from == Endian::N || data.empty()) return;
+  _impl::SwapBytes(data.data(), data.data(), data.size(), sizeof(T));
+}
+
 } // namespace platform
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <system_error>
+#include <filesystem>
+
+namespace platform {
+
+/// How 'LoadedFile' reads data.
+struct LoadOptions {
+  /// Count of reads kept in flight.
+  std::uint32_t queue_depth = 32;
+  /// Size of a single read.
+  std::size_t chunk_size = 512 << 10;
+  /// Whether asynchronous reads (io_uring) may be used; otherwise, or when
+  /// the kernel doesn't support them, file is read by 'pread' calls.
+  bool async = true;
+};  // struct LoadOptions
+
+/// File read into memory. Unlike 'MappedFile', data doesn't arrive by page
+/// faults one at a time: single thread keeps 'queue_depth' reads in flight,
+/// which is what cold NVMe drives need to reach full speed.
+class LoadedFile {
+ public:
+  /// Tries to read whole given file.
+  static std::expected<LoadedFile, std::error_code> Open(const std::filesystem::path& path, 
+                                                         const LoadOptions& options = {});
+
+  /// Size of file content.
+  std::size_t size() const { return size_; }
+  /// Pointer to file content.
+  const void* data() const { return data_.get(); }
+  /// Pointer to file content.
+  void* data() { return data_.get(); }
+
+ private:
+  LoadedFile() = default;
+
+  std::size_t size_;
+  std::unique_ptr<char[]> data_;
+};  // class LoadedFile
+
+}  // namespace platform
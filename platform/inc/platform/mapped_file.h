@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <expected>
 #include <system_error>
 #include <filesystem>
@@ -12,8 +13,26 @@ namespace platform {
 /// File mapped into process' address space.
 class MappedFile {
  public:
-  /// Tries to open given file.
+  /// Expected way of accessing a range of mapped data.
+  enum class Access {
+    /// No special treatment, default readahead.
+    Normal,
+    /// Read once from start to end, aggressive readahead.
+    Sequential,
+    /// Scattered reads, readahead is useless.
+    Random,
+    /// Will be read soon, start reading it now.
+    WillNeed,
+    /// Won't be read soon, its pages can be dropped.
+    DontNeed,
+  };  // enum class Access
+
+  /// Tries to open given file. Writes to mapping go to the file when
+  /// 'mode' has 'Write', mapping is read-only otherwise.
   static std::expected<MappedFile, std::error_code> Open(const std::filesystem::path& path, common::RwxRights mode);
+  /// Same as above, but maps only range [offset; offset + length) clamped to the file.
+  static std::expected<MappedFile, std::error_code> Open(const std::filesystem::path& path, common::RwxRights mode,
+                                                         std::size_t offset, std::size_t length);
 
   MappedFile(const MappedFile&) = delete;
   MappedFile& operator=(const MappedFile&) = delete;
@@ -21,24 +40,29 @@ class MappedFile {
   MappedFile& operator=(MappedFile&& other);
   ~MappedFile();
 
-  /// Size of mapped region (equal to file size).
+  /// Size of mapped range.
   std::size_t size() const { return size_; }
-  /// Pointer to file content.
+  /// Pointer to content of mapped range.
   const void* data() const { return data_; }
-  /// Pointer to file content.
+  /// Pointer to content of mapped range.
   void* data() { return data_; }
 
+  /// Advises OS how range [offset; offset + length) will be accessed,
+  /// range is relative to 'data()' and is clamped to 'size()'.
+  std::expected<void, std::error_code> Advise(Access access, std::size_t offset = 0, 
+                                              std::size_t length = SIZE_MAX);
+  /// Starts reading range [offset; offset + length) into memory in background.
+  std::expected<void, std::error_code> Prefetch(std::size_t offset, std::size_t length);
+
  private:
+  friend class WindowedFile;
+
   MappedFile() = default;
 
   std::size_t size_;
   void* data_;
-// actual type here is HANDLE but using it requires including
-// platform-dependent headers to end user, which is not ideal
-#ifdef OS_WINDOWS
-  void* file_;
-  void* mapping_;
-#endif
+  // distance from start of the mapping, which is aligned, to 'data_'
+  std::size_t lead_;
 };  // class MappedFile
 
 }  // namespace platform
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <system_error>
+#include <filesystem>
+
+#include <common/rights.h>
+#include <platform/mapped_file.h>
+
+namespace platform {
+
+/// Open file which maps only requested ranges, so huge files don't
+/// occupy address space and page tables as a whole.
+class WindowedFile {
+ public:
+  /// Tries to open given file, rights are the same as for 'MappedFile'.
+  static std::expected<WindowedFile, std::error_code> Open(const std::filesystem::path& path, common::RwxRights mode);
+
+  WindowedFile(const WindowedFile&) = delete;
+  WindowedFile& operator=(const WindowedFile&) = delete;
+  WindowedFile(WindowedFile&& other);
+  WindowedFile& operator=(WindowedFile&& other);
+  ~WindowedFile();
+
+  /// Size of the file.
+  std::size_t size() const { return size_; }
+
+  /// Maps range [offset; offset + length), clamped to the file. Mapping
+  /// itself starts at page boundary, bytes before 'offset' aren't visible.
+  /// Window stays valid after the file is closed.
+  std::expected<MappedFile, std::error_code> Lend(std::size_t offset, std::size_t length);
+
+  /// Advises OS how range [offset; offset + length) of the file will be
+  /// read, affects all windows. Ignored on Windows.
+  std::expected<void, std::error_code> Advise(MappedFile::Access access, std::size_t offset = 0, 
+                                              std::size_t length = SIZE_MAX);
+
+ private:
+  WindowedFile() = default;
+
+  std::size_t size_;
+  common::RwxRights mode_;
+// actual type here is HANDLE but using it requires including
+// platform-dependent headers to end user, which is not ideal
+#ifdef OS_WINDOWS
+  void* file_;
+  void* mapping_;
+#elifdef OS_UNIX
+  int fd_;
+#endif
+};  // class WindowedFile
+
+}  // namespace platform
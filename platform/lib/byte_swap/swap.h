@@ -0,0 +1,20 @@
+#pragma once
+// Byte swapping of value arrays built for different instruction sets.
+
+#include <cstddef>
+
+namespace swap_impl {
+
+// Reverses bytes of each of 'count' values from 'src' into 'dst';
+// they may be the same, but mustn't overlap otherwise.
+using SwapFn = void(*)(const char* src, char* dst, std::size_t count);
+
+// Uses byteswap instructions one value at a time.
+SwapFn SwapGeneric(std::size_t width);
+
+#ifdef PLATFORM_HAS_AVX2
+// Uses 32-byte shuffles, CPU must support AVX2.
+SwapFn SwapAvx2(std::size_t width);
+#endif
+
+}  // namespace swap_impl
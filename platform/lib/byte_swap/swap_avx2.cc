@@ -0,0 +1,21 @@
+// Built with AVX2 enabled, see CMakeLists.txt
+#include "swap.h"
+
+#ifdef PLATFORM_HAS_AVX2
+
+#include "swap_kernel.h"
+
+namespace swap_impl {
+
+SwapFn SwapAvx2(std::size_t width) {
+  switch (width) {
+   case 2: return &SwapVector<2>;
+   case 4: return &SwapVector<4>;
+   case 8: return &SwapVector<8>;
+  }
+  return nullptr;
+}
+
+}  // namespace swap_impl
+
+#endif
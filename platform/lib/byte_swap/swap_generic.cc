@@ -0,0 +1,15 @@
+#include "swap.h"
+#include "swap_kernel.h"
+
+namespace swap_impl {
+
+SwapFn SwapGeneric(std::size_t width) {
+  switch (width) {
+   case 2: return &SwapScalar<2>;
+   case 4: return &SwapScalar<4>;
+   case 8: return &SwapScalar<8>;
+  }
+  return nullptr;
+}
+
+}  // namespace swap_impl
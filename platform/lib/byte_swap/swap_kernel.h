@@ -0,0 +1,66 @@
+#pragma once
+// Byte swapping kernels: whole vectors are reordered by a byte shuffle,
+// values which don't fill a vector are swapped one by one.
+// Both swap_generic.cc and swap_avx2.cc build it with their own flags;
+// keep new helpers static or in the anonymous namespace.
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+# include <immintrin.h>
+#endif
+
+namespace swap_impl {
+
+namespace {
+
+template<std::size_t Width>
+struct UInt;
+
+template<> struct UInt<2> { using type = std::uint16_t; };
+template<> struct UInt<4> { using type = std::uint32_t; };
+template<> struct UInt<8> { using type = std::uint64_t; };
+
+template<std::size_t Width>
+inline void SwapScalar(const char* src, char* dst, std::size_t count) {
+  using T = typename UInt<Width>::type;
+  for (std::size_t i = 0; i < count; ++i) {
+    T value;
+    std::memcpy(&value, src + i * Width, Width);
+    value = std::byteswap(value);
+    std::memcpy(dst + i * Width, &value, Width);
+  }
+}
+
+#if defined(__AVX2__)
+// Shuffle which reverses each 'Width' bytes within both 16-byte lanes.
+template<std::size_t Width>
+inline __m256i ReverseMask() {
+  alignas(32) std::uint8_t mask[32];
+  for (std::size_t i = 0; i < 32; ++i) 
+    mask[i] = static_cast<std::uint8_t>((i % 16) / Width * Width + (Width - 1 - i % Width));
+  return _mm256_load_si256(reinterpret_cast<const __m256i*>(mask));
+}
+
+template<std::size_t Width>
+void SwapVector(const char* src, char* dst, std::size_t count) {
+  const __m256i mask = ReverseMask<Width>();
+  constexpr std::size_t per_vector = 32 / Width;
+
+  std::size_t i = 0;
+  for (; i + 2 * per_vector <= count; i += 2 * per_vector) {
+    auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * Width));
+    auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * Width + 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * Width), _mm256_shuffle_epi8(first, mask));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * Width + 32), _mm256_shuffle_epi8(second, mask));
+  }
+  SwapScalar<Width>(src + i * Width, dst + i * Width, count - i);
+}
+#endif
+
+}  // namespace
+
+}  // namespace swap_impl
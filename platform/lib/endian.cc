@@ -0,0 +1,35 @@
+#include "platform/endian.h"
+
+#include <array>
+#include <bit>
+#include <cassert>
+
+#include <common/cpu.h>
+
+#include "byte_swap/swap.h"
+
+namespace platform {
+
+namespace _impl {
+
+// Kernels for 2, 4 and 8 byte values.
+using SwapTable = std::array<swap_impl::SwapFn, 3>;
+
+static SwapTable SelectSwap() {
+  auto select = &swap_impl::SwapGeneric;
+#ifdef PLATFORM_HAS_AVX2
+  if (common::HasAvx2()) select = &swap_impl::SwapAvx2;
+#endif
+  return {select(2), select(4), select(8)};
+}
+
+void SwapBytes(const void* src, void* dst, std::size_t count, std::size_t width) {
+  static const SwapTable swap = SelectSwap();
+
+  assert(width >= 2 && width <= 8 && std::has_single_bit(width));
+  swap[std::countr_zero(width) - 1](static_cast<const char*>(src), static_cast<char*>(dst), count);
+}
+
+}  // namespace _impl
+
+}  // namespace platform
@@ -0,0 +1,199 @@
+#include "io_ring.h"
+
+#ifdef PLATFORM_HAS_IO_URING
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace platform {
+
+namespace _impl {
+
+namespace {
+
+// kernel caps ring size at 32K entries, deeper queues don't help anyway
+constexpr std::uint32_t kMaxEntries = 4096;
+
+template<typename T>
+T LoadAcquire(T* ptr) {
+  return std::atomic_ref<T>{*ptr}.load(std::memory_order_acquire);
+}
+
+template<typename T>
+void StoreRelease(T* ptr, T value) {
+  std::atomic_ref<T>{*ptr}.store(value, std::memory_order_release);
+}
+
+template<typename T>
+T* At(void* base, std::uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+}  // namespace
+
+IoRing* IoRing::ForThread(std::uint32_t depth) {
+  thread_local std::unique_ptr<IoRing> ring;
+  thread_local bool unavailable = false;
+
+  depth = std::clamp<std::uint32_t>(depth, 1, kMaxEntries);
+  if (unavailable) return nullptr;
+  if (ring && ring->entries_ >= depth) return ring.get();
+  ring.reset();
+
+  std::unique_ptr<IoRing> ret{new IoRing};
+  io_uring_params params{};
+  ret->fd_ = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+  // disabled by kernel config, seccomp or sysctl; don't try again
+  if (ret->fd_ < 0) {
+    unavailable = true;
+    return nullptr;
+  }
+  ret->entries_ = params.sq_entries;
+
+  ret->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ret->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) 
+    ret->sq_ring_size_ = ret->cq_ring_size_ = std::max(ret->sq_ring_size_, ret->cq_ring_size_);
+
+  auto map = [&ret](std::size_t size, off_t offset) -> void* {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ret->fd_, offset);
+    return (ptr == MAP_FAILED) ? nullptr : ptr;
+  };
+  ret->sq_ring_ = map(ret->sq_ring_size_, IORING_OFF_SQ_RING);
+  if (ret->sq_ring_ == nullptr) return nullptr;
+  if (single_mmap) {
+    ret->cq_ring_ = ret->sq_ring_;
+  } else {
+    ret->cq_ring_ = map(ret->cq_ring_size_, IORING_OFF_CQ_RING);
+    if (ret->cq_ring_ == nullptr) return nullptr;
+  }
+  ret->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ret->sqes_ = static_cast<io_uring_sqe*>(map(ret->sqes_size_, IORING_OFF_SQES));
+  if (ret->sqes_ == nullptr) return nullptr;
+
+  ret->sq_head_ = At<unsigned>(ret->sq_ring_, params.sq_off.head);
+  ret->sq_tail_ = At<unsigned>(ret->sq_ring_, params.sq_off.tail);
+  ret->sq_mask_ = At<unsigned>(ret->sq_ring_, params.sq_off.ring_mask);
+  ret->sq_array_ = At<unsigned>(ret->sq_ring_, params.sq_off.array);
+  ret->cq_head_ = At<unsigned>(ret->cq_ring_, params.cq_off.head);
+  ret->cq_tail_ = At<unsigned>(ret->cq_ring_, params.cq_off.tail);
+  ret->cq_mask_ = At<unsigned>(ret->cq_ring_, params.cq_off.ring_mask);
+  ret->cqes_ = At<io_uring_cqe>(ret->cq_ring_, params.cq_off.cqes);
+
+  ring = std::move(ret);
+  return ring.get();
+}
+
+IoRing::~IoRing() {
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  if (fd_ >= 0) close(fd_);
+}
+
+int IoRing::Read(int fd, char* dst, std::size_t size, std::size_t chunk, std::uint32_t depth) {
+  struct Request {
+    std::size_t offset;
+    std::size_t length;
+  };  // struct Request
+
+  depth = std::clamp<std::uint32_t>(depth, 1, entries_);
+  chunk = std::max<std::size_t>(chunk, 4096);
+
+  // requests in flight are identified by their slot
+  std::vector<Request> slots(depth);
+  std::vector<std::uint32_t> free_slots(depth);
+  for (std::uint32_t i = 0; i < depth; ++i) free_slots[i] = depth - 1 - i;
+  // remainders of short reads
+  std::vector<Request> retries;
+
+  std::size_t next = 0;
+  std::uint32_t in_flight = 0;
+  int error = 0;
+  unsigned to_submit = 0;
+  while (in_flight != 0 || (error == 0 && (next < size || !retries.empty()))) {
+    // queue new reads, unless some read failed and the rest is only drained
+    unsigned tail = *sq_tail_;
+    while (error == 0 && !free_slots.empty() && (next < size || !retries.empty())) {
+      Request request;
+      if (!retries.empty()) {
+        request = retries.back();
+        retries.pop_back();
+      } else {
+        request = {next, std::min(chunk, size - next)};
+        next += request.length;
+      }
+      auto slot = free_slots.back();
+      free_slots.pop_back();
+      slots[slot] = request;
+
+      unsigned index = tail & *sq_mask_;
+      auto& sqe = sqes_[index];
+      std::memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = IORING_OP_READ;
+      sqe.fd = fd;
+      sqe.addr = reinterpret_cast<std::uint64_t>(dst + request.offset);
+      sqe.len = static_cast<std::uint32_t>(request.length);
+      sqe.off = request.offset;
+      sqe.user_data = slot;
+      sq_array_[index] = index;
+      ++tail;
+      ++in_flight;
+      ++to_submit;
+    }
+    StoreRelease(sq_tail_, tail);
+
+    int submitted = static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit, 1, 
+                                             IORING_ENTER_GETEVENTS, nullptr, 0));
+    if (submitted < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+      // kernel reads the queue only inside the call, so not submitted requests
+      // can be taken back; the ones already running still write into 'dst'
+      if (error == 0) error = errno;
+      StoreRelease(sq_tail_, tail - to_submit);
+      in_flight -= to_submit;
+      to_submit = 0;
+      if (in_flight == 0) break;
+      continue;
+    }
+    to_submit -= submitted;
+
+    unsigned head = *cq_head_;
+    unsigned cq_tail = LoadAcquire(cq_tail_);
+    for (; head != cq_tail; ++head) {
+      auto& cqe = cqes_[head & *cq_mask_];
+      auto slot = static_cast<std::uint32_t>(cqe.user_data);
+      auto request = slots[slot];
+      free_slots.push_back(slot);
+      --in_flight;
+
+      if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+        retries.push_back(request);
+      } else if (cqe.res < 0) {
+        if (error == 0) error = -cqe.res;
+      } else if (cqe.res == 0) {
+        // file was truncated while being read
+        if (error == 0) error = EIO;
+      } else if (static_cast<std::size_t>(cqe.res) < request.length) {
+        retries.push_back({request.offset + cqe.res, request.length - cqe.res});
+      }
+    }
+    StoreRelease(cq_head_, head);
+  }
+  return error;
+}
+
+}  // namespace _impl
+
+}  // namespace platform
+
+#endif  // PLATFORM_HAS_IO_URING
@@ -0,0 +1,58 @@
+#pragma once
+// Minimal io_uring client built on raw syscalls, so liburing isn't needed.
+
+#ifdef PLATFORM_HAS_IO_URING
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace platform {
+
+namespace _impl {
+
+class IoRing {
+ public:
+  /// Returns ring of calling thread with at least 'depth' entries,
+  /// or null if kernel doesn't allow io_uring.
+  static IoRing* ForThread(std::uint32_t depth);
+
+  IoRing(const IoRing&) = delete;
+  IoRing& operator=(const IoRing&) = delete;
+  ~IoRing();
+
+  /// Reads [0; size) of 'fd' into 'dst' by reads of 'chunk' bytes with
+  /// at most 'depth' of them in flight. Returns 0 or 'errno' value.
+  int Read(int fd, char* dst, std::size_t size, std::size_t chunk, std::uint32_t depth);
+
+ private:
+  IoRing() = default;
+
+  int fd_ = -1;
+  std::uint32_t entries_ = 0;
+
+  void* sq_ring_ = nullptr;
+  std::size_t sq_ring_size_ = 0;
+  void* cq_ring_ = nullptr;
+  std::size_t cq_ring_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  std::size_t sqes_size_ = 0;
+
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned* sq_mask_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned* cq_mask_;
+  io_uring_cqe* cqes_;
+};  // class IoRing
+
+}  // namespace _impl
+
+}  // namespace platform
+
+#endif  // PLATFORM_HAS_IO_URING
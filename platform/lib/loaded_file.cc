@@ -0,0 +1,91 @@
+#include "platform/loaded_file.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "os.h"
+#include "io_ring.h"
+
+namespace platform {
+
+using _impl::OsError;
+
+std::expected<LoadedFile, std::error_code> LoadedFile::Open(const std::filesystem::path& path, 
+                                                            const LoadOptions& options) {
+#ifdef OS_WINDOWS
+  auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, 
+                          OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (file == INVALID_HANDLE_VALUE) return OsError();
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    auto err = OsError();
+    CloseHandle(file);
+    return err;
+  }
+
+  LoadedFile ret;
+  ret.size_ = size.QuadPart;
+  ret.data_ = std::make_unique_for_overwrite<char[]>(ret.size_);
+
+  for (std::size_t pos = 0; pos < ret.size_;) {
+    auto length = static_cast<DWORD>(std::min<std::size_t>(options.chunk_size, ret.size_ - pos));
+    DWORD done = 0;
+    if (!ReadFile(file, ret.data_.get() + pos, length, &done, NULL) || done == 0) {
+      auto err = OsError();
+      CloseHandle(file);
+      return err;
+    }
+    pos += done;
+  }
+  CloseHandle(file);
+#elifdef OS_UNIX
+  int fd = open(path.c_str(), O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+  if (fd == -1) return OsError();
+
+  struct stat64 stats;
+  if (fstat64(fd, &stats) != 0) {
+    auto err = OsError();
+    close(fd);
+    return err;
+  }
+
+  LoadedFile ret;
+  ret.size_ = stats.st_size;
+  ret.data_ = std::make_unique_for_overwrite<char[]>(ret.size_);
+  // whole file is read once, let the kernel read ahead of requests
+  posix_fadvise64(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  int err = 0;
+  bool loaded = false;
+#ifdef PLATFORM_HAS_IO_URING
+  // single read doesn't need a queue
+  if (options.async && ret.size_ > options.chunk_size) {
+    if (auto ring = _impl::IoRing::ForThread(options.queue_depth)) {
+      err = ring->Read(fd, ret.data_.get(), ret.size_, options.chunk_size, options.queue_depth);
+      // kernels before 5.6 have io_uring without plain reads
+      loaded = (err != EINVAL && err != EOPNOTSUPP);
+      if (!loaded) err = 0;
+    }
+  }
+#endif
+  // synchronous fallback
+  for (std::size_t pos = 0; !loaded && err == 0 && pos < ret.size_;) {
+    auto length = std::min(std::max<std::size_t>(options.chunk_size, 1), ret.size_ - pos);
+    auto done = pread64(fd, ret.data_.get() + pos, length, pos);
+    if (done > 0) {
+      pos += done;
+    } else if (done == 0) {
+      // file was truncated while being read
+      err = EIO;
+    } else if (errno != EINTR) {
+      err = errno;
+    }
+  }
+  close(fd);
+  if (err != 0) return std::unexpected(std::error_code{err, std::system_category()});
+#endif
+  return std::move(ret);
+}
+
+}  // namespace platform
@@ -1,122 +1,68 @@
 #include "platform/mapped_file.h"
 
+#include <cstdint>
 #include <utility>
 
-#ifdef OS_WINDOWS
-# include <Windows.h>
-# define OS_ERROR static_cast<int>(GetLastError())
-#elifdef OS_UNIX
-# include <fcntl.h>
-# include <sys/mman.h>
-# include <sys/stat.h>
-# include <unistd.h>
-# include <errno.h>
-#include "mapped_file.h"
-# define OS_ERROR errno
-#endif
+#include <platform/windowed_file.h>
+
+#include "os.h"
 
 namespace platform {
 
-static auto OsError() {
-  return std::unexpected(std::error_code { 
-    OS_ERROR, 
-    std::system_category()
-  });
-}
+using _impl::OsError;
 
 std::expected<MappedFile, std::error_code> MappedFile::Open(const std::filesystem::path& path, common::RwxRights mode) {
-#ifdef OS_WINDOWS
-  DWORD file_mode = 0;
-  if (mode << common::RwxRights::Read) file_mode |= GENERIC_READ;
-  if (mode << common::RwxRights::Write) file_mode |= GENERIC_WRITE;
-
-  auto file = CreateFileW(path.c_str(), file_mode, FILE_SHARE_READ, NULL, 
-                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
-
-  if (file == INVALID_HANDLE_VALUE) return OsError();
+  return Open(path, mode, 0, SIZE_MAX);
+}
 
-  LARGE_INTEGER size;
-  if (!GetFileSizeEx(file, &size)) {
-    auto err = OsError();
-    CloseHandle(file);
-    return err;
-  }
+std::expected<MappedFile, std::error_code> MappedFile::Open(const std::filesystem::path& path, common::RwxRights mode,
+                                                            std::size_t offset, std::size_t length) {
+  // mapping stays valid after the file is closed
+  auto file = WindowedFile::Open(path, mode);
+  if (!file) return std::unexpected(file.error());
+  return file->Lend(offset, length);
+}
 
-  DWORD prot_mode = 0;
-  switch (mode) {
-   case common::RwxRights::Read:
-    prot_mode = PAGE_READONLY;
-    break;
-   case common::RwxRights::Write:
-   case common::RwxRights::Read | common::RwxRights::Write:
-    prot_mode = PAGE_READWRITE;
-    break;
-   case common::RwxRights::Execute:
-   case common::RwxRights::Read | common::RwxRights::Execute:
-    prot_mode = PAGE_EXECUTE_READ;
-    break;
-   case common::RwxRights::Write | common::RwxRights::Execute:
-   case common::RwxRights::Read | common::RwxRights::Write | common::RwxRights::Execute:
-    prot_mode = PAGE_EXECUTE_READWRITE;
-    break;
+#ifdef OS_UNIX
+static int ToAdvice(MappedFile::Access access) {
+  switch (access) {
+   case MappedFile::Access::Sequential: return MADV_SEQUENTIAL;
+   case MappedFile::Access::Random: return MADV_RANDOM;
+   case MappedFile::Access::WillNeed: return MADV_WILLNEED;
+   case MappedFile::Access::DontNeed: return MADV_DONTNEED;
+   default: return MADV_NORMAL;
   }
+}
+#endif
 
-  auto map = CreateFileMappingA(file, NULL, prot_mode, 0, 0, NULL);
-  if (map == NULL) {
-    auto err = OsError();
-    CloseHandle(file);
-    return err;
-  }
+std::expected<void, std::error_code> MappedFile::Advise(Access access, std::size_t offset, std::size_t length) {
+  if (offset >= size_) return {};
+  if (length > size_ - offset) length = size_ - offset;
 
-  DWORD map_mode = 0;
-  if (mode << common::RwxRights::Read) map_mode |= FILE_MAP_READ;
-  if (mode << common::RwxRights::Write) map_mode |= FILE_MAP_WRITE;
-  if (mode << common::RwxRights::Execute) map_mode |= FILE_MAP_EXECUTE;
-
-  auto ptr = MapViewOfFile(map, map_mode, 0, 0, 0);
-  if (ptr == NULL) {
-    auto err = OsError();
-    CloseHandle(map);
-    CloseHandle(file);
-    return err;
-  }
+#ifdef OS_WINDOWS
+  // only prefetching has an equivalent, other hints are ignored
+  if (access != Access::WillNeed) return {};
 
-  MappedFile ret;
-  ret.file_ = file;
-  ret.mapping_ = map;
-  ret.size_ = size.QuadPart;
-  ret.data_ = ptr;
+  WIN32_MEMORY_RANGE_ENTRY range{static_cast<char*>(data_) + offset, length};
+  if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0)) return OsError();
 #elifdef OS_UNIX
-  // TODO account for access mode on UNIX
-  int fd = open(path, O_RDWR | O_LARGEFILE);
-  if (fd == -1) return OsError();
-
-  struct stat64 stats;
-  if (fstat64(fd, &stats) != 0) {
-    auto err = OsError();
-    close(fd);
+  // advised range must start at page boundary
+  auto begin = reinterpret_cast<std::uintptr_t>(data_) + offset;
+  auto aligned = begin & ~static_cast<std::uintptr_t>(_impl::MapAlignment() - 1);
+  if (madvise(reinterpret_cast<void*>(aligned), length + (begin - aligned), ToAdvice(access)) != 0) 
     return OsError();
-  }
-
-  auto data = mmap64(nullptr, stats.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
-  auto err = OsError();
-  close(fd);
-  if (data == reinterpret_cast<void*>(-1)) return OsError();
-
-  MappedFile ret;
-  ret.size_ = stats.st_size;
-  ret.data_ = data;
 #endif
-  return std::move(ret);
+  return {};
+}
+
+std::expected<void, std::error_code> MappedFile::Prefetch(std::size_t offset, std::size_t length) {
+  return Advise(Access::WillNeed, offset, length);
 }
 
 MappedFile::MappedFile(MappedFile&& other) 
   : size_{std::exchange(other.size_, 0)}
   , data_{std::exchange(other.data_, nullptr)}
-#ifdef OS_WINDOWS
-  , file_{std::exchange(other.file_, nullptr)}
-  , mapping_{std::exchange(other.mapping_, nullptr)}
-#endif
+  , lead_{std::exchange(other.lead_, 0)}
   {}
 
 MappedFile& MappedFile::operator=(MappedFile&& other) {
@@ -128,13 +74,12 @@ MappedFile& MappedFile::operator=(MappedFile&& other) {
 MappedFile::~MappedFile() {
   if (data_ == nullptr) return;
 
+  void* base = static_cast<char*>(data_) - lead_;
 #ifdef OS_WINDOWS
-  UnmapViewOfFile(data_);
-  CloseHandle(mapping_);
-  CloseHandle(file_);
+  UnmapViewOfFile(base);
 #elifdef OS_UNIX
-  munmap(data_, size_);
+  munmap(base, lead_ + size_);
 #endif
 }
 
-}  // namespace platform
\ No newline at end of file
+}  // namespace platform
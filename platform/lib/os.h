@@ -0,0 +1,47 @@
+#pragma once
+// Platform headers and error reporting shared by implementation files.
+
+#include <expected>
+#include <system_error>
+
+#ifdef OS_WINDOWS
+# include <Windows.h>
+# define OS_ERROR static_cast<int>(GetLastError())
+#elifdef OS_UNIX
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+# include <errno.h>
+# define OS_ERROR errno
+#endif
+
+namespace platform {
+
+namespace _impl {
+
+/// Error of the last failed system call.
+inline auto OsError() {
+  return std::unexpected(std::error_code { 
+    OS_ERROR, 
+    std::system_category()
+  });
+}
+
+/// Granularity of mapping offsets.
+inline std::size_t MapAlignment() {
+#ifdef OS_WINDOWS
+  static const std::size_t ret = [] {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<std::size_t>(info.dwAllocationGranularity);
+  }();
+#elifdef OS_UNIX
+  static const std::size_t ret = sysconf(_SC_PAGESIZE);
+#endif
+  return ret;
+}
+
+}  // namespace _impl
+
+}  // namespace platform
@@ -0,0 +1,171 @@
+#include "platform/windowed_file.h"
+
+#include <utility>
+
+#include "os.h"
+
+namespace platform {
+
+using _impl::OsError;
+
+std::expected<WindowedFile, std::error_code> WindowedFile::Open(const std::filesystem::path& path, common::RwxRights mode) {
+#ifdef OS_WINDOWS
+  DWORD file_mode = 0;
+  if (mode << common::RwxRights::Read) file_mode |= GENERIC_READ;
+  if (mode << common::RwxRights::Write) file_mode |= GENERIC_WRITE;
+
+  auto file = CreateFileW(path.c_str(), file_mode, FILE_SHARE_READ, NULL, 
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if (file == INVALID_HANDLE_VALUE) return OsError();
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    auto err = OsError();
+    CloseHandle(file);
+    return err;
+  }
+
+  DWORD prot_mode = 0;
+  switch (mode) {
+   case common::RwxRights::Read:
+    prot_mode = PAGE_READONLY;
+    break;
+   case common::RwxRights::Write:
+   case common::RwxRights::Read | common::RwxRights::Write:
+    prot_mode = PAGE_READWRITE;
+    break;
+   case common::RwxRights::Execute:
+   case common::RwxRights::Read | common::RwxRights::Execute:
+    prot_mode = PAGE_EXECUTE_READ;
+    break;
+   case common::RwxRights::Write | common::RwxRights::Execute:
+   case common::RwxRights::Read | common::RwxRights::Write | common::RwxRights::Execute:
+    prot_mode = PAGE_EXECUTE_READWRITE;
+    break;
+  }
+
+  // empty files can't be mapped, but they're still valid
+  HANDLE map = NULL;
+  if (size.QuadPart != 0) {
+    map = CreateFileMappingA(file, NULL, prot_mode, 0, 0, NULL);
+    if (map == NULL) {
+      auto err = OsError();
+      CloseHandle(file);
+      return err;
+    }
+  }
+
+  WindowedFile ret;
+  ret.file_ = file;
+  ret.mapping_ = map;
+  ret.size_ = size.QuadPart;
+#elifdef OS_UNIX
+  // shared writable mapping needs descriptor opened for both reading and writing
+  int open_mode = (mode << common::RwxRights::Write) ? O_RDWR : O_RDONLY;
+  int fd = open(path.c_str(), open_mode | O_LARGEFILE | O_CLOEXEC);
+  if (fd == -1) return OsError();
+
+  struct stat64 stats;
+  if (fstat64(fd, &stats) != 0) {
+    auto err = OsError();
+    close(fd);
+    return err;
+  }
+
+  WindowedFile ret;
+  ret.fd_ = fd;
+  ret.size_ = stats.st_size;
+#endif
+  ret.mode_ = mode;
+  return std::move(ret);
+}
+
+std::expected<MappedFile, std::error_code> WindowedFile::Lend(std::size_t offset, std::size_t length) {
+  if (offset > size_) offset = size_;
+  if (length > size_ - offset) length = size_ - offset;
+
+  MappedFile ret;
+  ret.size_ = length;
+  ret.data_ = nullptr;
+  ret.lead_ = 0;
+  if (length == 0) return std::move(ret);
+
+  std::size_t begin = offset & ~(_impl::MapAlignment() - 1);
+  std::size_t lead = offset - begin;
+
+#ifdef OS_WINDOWS
+  DWORD map_mode = 0;
+  if (mode_ << common::RwxRights::Read) map_mode |= FILE_MAP_READ;
+  if (mode_ << common::RwxRights::Write) map_mode |= FILE_MAP_WRITE;
+  if (mode_ << common::RwxRights::Execute) map_mode |= FILE_MAP_EXECUTE;
+
+  auto ptr = MapViewOfFile(mapping_, map_mode, 
+                           static_cast<DWORD>(static_cast<std::uint64_t>(begin) >> 32), 
+                           static_cast<DWORD>(begin), 
+                           lead + length);
+  if (ptr == NULL) return OsError();
+#elifdef OS_UNIX
+  int prot_mode = PROT_NONE;
+  if (mode_ << common::RwxRights::Read) prot_mode |= PROT_READ;
+  if (mode_ << common::RwxRights::Write) prot_mode |= PROT_WRITE;
+  if (mode_ << common::RwxRights::Execute) prot_mode |= PROT_EXEC;
+
+  auto ptr = mmap64(nullptr, lead + length, prot_mode, MAP_SHARED, fd_, begin);
+  if (ptr == MAP_FAILED) return OsError();
+#endif
+  ret.data_ = static_cast<char*>(ptr) + lead;
+  ret.lead_ = lead;
+  return std::move(ret);
+}
+
+std::expected<void, std::error_code> WindowedFile::Advise(MappedFile::Access access, std::size_t offset, std::size_t length) {
+  if (offset >= size_) return {};
+  if (length > size_ - offset) length = size_ - offset;
+
+#ifdef OS_WINDOWS
+  // file handles have no such hints
+  (void)access;
+#elifdef OS_UNIX
+  int advice = POSIX_FADV_NORMAL;
+  switch (access) {
+   case MappedFile::Access::Sequential: advice = POSIX_FADV_SEQUENTIAL; break;
+   case MappedFile::Access::Random: advice = POSIX_FADV_RANDOM; break;
+   case MappedFile::Access::WillNeed: advice = POSIX_FADV_WILLNEED; break;
+   case MappedFile::Access::DontNeed: advice = POSIX_FADV_DONTNEED; break;
+   default: break;
+  }
+  // reports error by return value, not by 'errno'
+  if (int err = posix_fadvise64(fd_, offset, length, advice); err != 0) 
+    return std::unexpected(std::error_code{err, std::system_category()});
+#endif
+  return {};
+}
+
+WindowedFile::WindowedFile(WindowedFile&& other) 
+  : size_{std::exchange(other.size_, 0)}
+  , mode_{other.mode_}
+#ifdef OS_WINDOWS
+  , file_{std::exchange(other.file_, INVALID_HANDLE_VALUE)}
+  , mapping_{std::exchange(other.mapping_, nullptr)}
+#elifdef OS_UNIX
+  , fd_{std::exchange(other.fd_, -1)}
+#endif
+  {}
+
+WindowedFile& WindowedFile::operator=(WindowedFile&& other) {
+  this->~WindowedFile();
+  new (this) WindowedFile(std::forward<WindowedFile>(other));
+  return *this;
+}
+
+WindowedFile::~WindowedFile() {
+#ifdef OS_WINDOWS
+  if (mapping_ != nullptr) CloseHandle(mapping_);
+  if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+#elifdef OS_UNIX
+  if (fd_ != -1) close(fd_);
+#endif
+}
+
+}  // namespace platform
@@ -0,0 +1,344 @@
+#include "extractor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <common/hash.h>
+#include <common/rights.h>
+#include <platform/loaded_file.h>
+#include <platform/windowed_file.h>
+#include <unity/file/asset.h>
+#include <unity/file/bundle.h>
+
+namespace playground {
+
+namespace fs = std::filesystem;
+
+static constexpr std::string_view kManifestName = ".manifest";
+// including terminator
+static constexpr std::string_view kBundleSignature{"UnityFS", 8};
+// prefetched before the input type is known, covers header
+// and block info of most bundles
+static constexpr std::size_t kHeadSize = 64 << 10;
+
+static bool IsBundle(std::span<const char> head) {
+  return head.size() >= kBundleSignature.size() && 
+         std::equal(kBundleSignature.begin(), kBundleSignature.end(), head.begin());
+}
+
+// Turns name of a file inside bundle (e.g. "archive:/CAB-1/CAB-1.resS")
+// into a relative path below the output directory of the bundle. Returns
+// empty path for names which can't be placed there, like "." or "a/../..".
+static fs::path EntryPath(const std::string& name) {
+  std::string sanitized = name;
+  for (auto& c : sanitized) {
+    if (c == ':' || c == '\\') c = '_';
+  }
+  auto ret = fs::path{sanitized}.relative_path().lexically_normal();
+  for (auto& part : ret) {
+    if (part == "." || part == "..") return {};
+  }
+  return ret;
+}
+
+// Whether 'path' is inside of 'root' and isn't 'root' itself.
+static bool IsStrictlyBelow(const fs::path& path, const fs::path& root) {
+  auto relative = path.lexically_normal().lexically_relative(root.lexically_normal());
+  if (relative.empty() || relative == ".") return false;
+  for (auto& part : relative) {
+    if (part == "..") return false;
+  }
+  return true;
+}
+
+Extractor::Extractor(ExtractOptions options)
+  : options_{std::move(options)}
+  , pool_{options_.jobs}
+  , cache_{options_.cache_size}
+  , in_flight_{static_cast<std::ptrdiff_t>(2 * options_.jobs)}
+  {}
+
+void Extractor::Run() {
+  std::error_code err;
+  fs::create_directories(options_.output, err);
+  if (err) return ReportError(options_.output, err.message());
+
+  auto manifest_path = options_.output / kManifestName;
+  if (options_.incremental) {
+    auto manifest = Manifest::Load(manifest_path);
+    if (manifest) {
+      previous_ = *std::move(manifest);
+    } else {
+      std::lock_guard lock{log_mutex_};
+      std::cerr << manifest_path.string() << ": " << manifest.error() << ", extracting everything\n";
+    }
+  }
+
+  common::TaskGroup group{pool_};
+
+  fs::recursive_directory_iterator it{options_.root, fs::directory_options::skip_permission_denied, err};
+  for (; !err && it != fs::recursive_directory_iterator{}; it.increment(err)) {
+    std::error_code entry_err;
+    if (!it->is_regular_file(entry_err)) continue;
+    std::uint64_t size = it->file_size(entry_err);
+    std::int64_t mtime = it->last_write_time(entry_err).time_since_epoch().count();
+    if (entry_err || size == 0) continue;
+    stats_.inputs.fetch_add(1, std::memory_order_relaxed);
+
+    auto key = it->path().lexically_relative(options_.root).generic_string();
+    auto previous = previous_.inputs.find(key);
+    bool known = previous != previous_.inputs.end();
+    if (known && previous->second.size == size && previous->second.mtime == mtime) {
+      stats_.unchanged_inputs.fetch_add(1, std::memory_order_relaxed);
+      std::lock_guard lock{manifest_mutex_};
+      current_.inputs.emplace(key, previous->second);
+      continue;
+    }
+
+    auto job = std::make_unique<Job>();
+    job->path = it->path();
+    job->out = options_.output / it->path().lexically_relative(options_.root);
+    job->key = std::move(key);
+    job->previous = known ? &previous->second : nullptr;
+    job->record = ManifestInput{size, mtime, {}};
+
+    in_flight_.acquire();
+    group.Run([this, job = std::move(job)] {
+      ExtractInput(*job);
+      if (!job->failed) {
+        std::lock_guard lock{manifest_mutex_};
+        current_.inputs.insert_or_assign(std::move(job->key), std::move(job->record));
+      }
+      in_flight_.release();
+    });
+  }
+  if (err) ReportError(options_.root, err.message());
+
+  group.Wait();
+
+  RemoveStale();
+  if (auto save_err = current_.Save(manifest_path)) ReportError(manifest_path, *save_err);
+}
+
+void Extractor::ExtractInput(Job& job) {
+  if (options_.load) {
+    auto file = platform::LoadedFile::Open(job.path, {.queue_depth = options_.queue_depth});
+    if (!file) return ReportError(job, job.path, file.error().message());
+
+    if (IsBundle({static_cast<const char*>(file->data()), file->size()})) 
+      return ExtractBundle(job, *std::move(file));
+    return ExtractSerialized(job, *std::move(file));
+  }
+
+  auto file = platform::WindowedFile::Open(job.path, common::RwxRights::Read);
+  if (!file) return ReportError(job, job.path, file.error().message());
+
+  // inputs are read through about once, so let the kernel read ahead instead
+  // of faulting pages in one by one; hints are best effort. Only the head
+  // is needed until the input is known to be a Unity file.
+  (void)file->Advise(platform::MappedFile::Access::Sequential);
+  (void)file->Advise(platform::MappedFile::Access::WillNeed, 0, kHeadSize);
+
+  auto head = file->Lend(0, kBundleSignature.size());
+  if (!head) return ReportError(job, job.path, head.error().message());
+  if (IsBundle({static_cast<const char*>(head->data()), head->size()})) {
+    // block data follows the head; only blocks which are being unpacked are mapped
+    (void)file->Advise(platform::MappedFile::Access::WillNeed, kHeadSize);
+    return ExtractBundle(job, *std::move(file));
+  }
+
+  // serialized files are parsed as a whole
+  auto whole = file->Lend(0, file->size());
+  if (!whole) return ReportError(job, job.path, whole.error().message());
+  ExtractSerialized(job, *std::move(whole));
+}
+
+template<typename Source>
+void Extractor::ExtractSerialized(Job& job, Source&& file) {
+  if (!unity::file::Asset::Detect(file)) return;
+  // rest of a mapped file is prefetched only when it's known to be needed
+  if constexpr (requires { file.Advise(platform::MappedFile::Access::WillNeed, kHeadSize); })
+    (void)file.Advise(platform::MappedFile::Access::WillNeed, kHeadSize);
+
+  auto hash = common::Hash64({static_cast<const char*>(file.data()), file.size()});
+  if (auto unchanged = FindUnchanged(job, "", hash)) {
+    stats_.unchanged_files.fetch_add(1, std::memory_order_relaxed);
+    return AddEntry(job, "", *unchanged);
+  }
+  ExtractAsset(job, "", hash, std::forward<Source>(file));
+}
+
+template<typename Source>
+void Extractor::ExtractBundle(Job& job, Source&& file) {
+  auto bundle = unity::file::Bundle::Read(std::forward<Source>(file));
+  if (!bundle) return ReportError(job, job.path, bundle.error());
+  stats_.bundles.fetch_add(1, std::memory_order_relaxed);
+
+  // files which share a block are unpacked concurrently, so partial blocks
+  // go through the cache instead of being decompressed twice
+  bundle->set_cache(&cache_);
+
+  common::TaskGroup group{pool_};
+  const auto* entry = &bundle->first_file();
+  for (std::uint32_t i = 0; i < bundle->file_count; ++i, entry = &entry->next()) {
+    group.Run([this, &job, &bundle = *bundle, entry] {
+      std::string name = entry->name();
+      // such files are skipped, failing the whole bundle would extract it on every run
+      if (EntryPath(name).empty()) return ReportError(job.path / name, "file name escapes output directory");
+      std::size_t offset = entry->offset;
+      std::size_t size = entry->size;
+
+      auto packed = bundle.PackedData(offset, size);
+      if (!packed) return ReportError(job, job.path / name, packed.error());
+
+      // same packed blocks placed at the same offset unpack to the same file
+      std::uint64_t range[] = {offset, size};
+      auto seed = common::Hash64({reinterpret_cast<const char*>(range), sizeof(range)});
+      auto hash = common::Hash64(packed->data, seed);
+      if (auto unchanged = FindUnchanged(job, name, hash)) {
+        stats_.unchanged_files.fetch_add(1, std::memory_order_relaxed);
+        return AddEntry(job, name, *unchanged);
+      }
+
+      std::unique_ptr<char[]> storage;
+      std::span<const char> data;
+      if (auto view = bundle.ViewData(offset, size)) {
+        data = *view;
+      } else {
+        storage = std::make_unique_for_overwrite<char[]>(size);
+        auto err = bundle.UnpackData(offset, {storage.get(), size}, pool_);
+        if (err) return ReportError(job, job.path / name, *err);
+        data = {storage.get(), size};
+      }
+      ExtractEntry(job, name, hash, data);
+    });
+  }
+  group.Wait();
+
+  // files removed from the bundle
+  if (job.failed || job.previous == nullptr) return;
+  for (auto& [name, _] : job.previous->entries) {
+    if (name.empty() || job.record.entries.contains(name)) continue;
+    // manifest may come from anywhere, so nothing but a single entry is removed
+    auto path = EntryPath(name);
+    if (path.empty() || !IsStrictlyBelow(job.out / path, job.out)) continue;
+    std::error_code err;
+    fs::remove_all(job.out / path, err);
+  }
+}
+
+void Extractor::ExtractEntry(Job& job, const std::string& name, std::uint64_t hash, std::span<const char> data) {
+  if (unity::file::Asset::Detect(data)) return ExtractAsset(job, name, hash, data);
+
+  auto out = job.out / EntryPath(name);
+  std::error_code err;
+  fs::create_directories(out.parent_path(), err);
+  if (!WriteFile(job, out, data)) return;
+  AddEntry(job, name, ManifestEntry{hash, {}});
+}
+
+template<typename Source>
+void Extractor::ExtractAsset(Job& job, const std::string& name, std::uint64_t hash, Source&& source) {
+  auto path = name.empty() ? job.path : job.path / name;
+  auto out = name.empty() ? job.out : job.out / EntryPath(name);
+
+  auto asset = unity::file::Asset::Read(std::forward<Source>(source));
+  if (!asset) return ReportError(job, path, asset.error());
+  stats_.assets.fetch_add(1, std::memory_order_relaxed);
+
+  std::error_code err;
+  fs::create_directories(out, err);
+  if (err) return ReportError(job, out, err.message());
+
+  // objects are compared one by one with the previous version of the file
+  const ManifestEntry* previous = nullptr;
+  if (job.previous != nullptr) {
+    auto it = job.previous->entries.find(name);
+    if (it != job.previous->entries.end()) previous = &it->second;
+  }
+
+  ManifestEntry entry{hash, {}};
+  // object ranges are validated by 'Asset::Read'
+  for (std::uint32_t i = 0; i < asset->object_count; ++i) {
+    auto object = asset->objects[i];
+
+    auto object_name = std::to_string(object.path_id) + "." + std::to_string(static_cast<std::int32_t>(object.class_id));
+    auto data = asset->GetObject(i);
+    auto object_hash = common::Hash64(data);
+    entry.objects.emplace(object_name, object_hash);
+
+    if (previous != nullptr) {
+      auto it = previous->objects.find(object_name);
+      if (it != previous->objects.end() && it->second == object_hash) {
+        stats_.unchanged_objects.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+    }
+    if (WriteFile(job, out / object_name, data)) 
+      stats_.objects.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // objects removed from the file
+  if (previous != nullptr) {
+    for (auto& [object_name, _] : previous->objects) {
+      if (!entry.objects.contains(object_name)) fs::remove(out / object_name, err);
+    }
+  }
+  AddEntry(job, name, std::move(entry));
+}
+
+const ManifestEntry* Extractor::FindUnchanged(const Job& job, const std::string& name, std::uint64_t hash) const {
+  if (job.previous == nullptr) return nullptr;
+  auto it = job.previous->entries.find(name);
+  if (it == job.previous->entries.end() || it->second.hash != hash) return nullptr;
+  return &it->second;
+}
+
+void Extractor::AddEntry(Job& job, const std::string& name, ManifestEntry entry) {
+  std::lock_guard lock{job.mutex};
+  job.record.entries.insert_or_assign(name, std::move(entry));
+}
+
+void Extractor::RemoveStale() {
+  for (auto& [key, _] : previous_.inputs) {
+    if (current_.inputs.contains(key)) continue;
+
+    // inputs which failed this time keep their old outputs
+    std::error_code err;
+    fs::path relative{key};
+    if (relative.is_absolute() || relative.lexically_normal().string().starts_with("..")) continue;
+    if (fs::exists(options_.root / relative, err) || err) continue;
+    fs::remove_all(options_.output / relative, err);
+  }
+}
+
+bool Extractor::WriteFile(Job& job, const fs::path& path, std::span<const char> data) {
+  std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+  if (stream) stream.write(data.data(), data.size());
+  if (!stream) {
+    ReportError(job, path, "can't write file");
+    return false;
+  }
+
+  stats_.files.fetch_add(1, std::memory_order_relaxed);
+  stats_.bytes.fetch_add(data.size(), std::memory_order_relaxed);
+  return true;
+}
+
+void Extractor::ReportError(const fs::path& path, std::string_view message) {
+  stats_.errors.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard lock{log_mutex_};
+  std::cerr << path.string() << ": " << message << '\n';
+}
+
+void Extractor::ReportError(Job& job, const fs::path& path, std::string_view message) {
+  job.failed = true;
+  ReportError(path, message);
+}
+
+}  // namespace playground
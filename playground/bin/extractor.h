@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <semaphore>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <common/thread_pool.h>
+#include <platform/windowed_file.h>
+#include <unity/file/block_cache.h>
+
+#include "manifest.h"
+
+namespace playground {
+
+struct ExtractOptions {
+  std::filesystem::path root;
+  std::filesystem::path output;
+  // worker threads
+  std::size_t jobs;
+  // budget for unpacked blocks shared by files of the same bundle
+  std::size_t cache_size = 64 << 20;
+  // skip what the manifest of the previous run says is unchanged
+  bool incremental = true;
+  // read inputs into memory by deep queues of reads instead of mapping them,
+  // faster for cold storage where page faults serialize reads
+  bool load = false;
+  std::uint32_t queue_depth = 32;
+};  // struct ExtractOptions
+
+struct ExtractStats {
+  std::atomic<std::uint64_t> inputs = 0;
+  std::atomic<std::uint64_t> bundles = 0;
+  std::atomic<std::uint64_t> assets = 0;
+  std::atomic<std::uint64_t> objects = 0;
+  std::atomic<std::uint64_t> files = 0;
+  std::atomic<std::uint64_t> bytes = 0;
+  std::atomic<std::uint64_t> errors = 0;
+  // skipped as unchanged since the previous run
+  std::atomic<std::uint64_t> unchanged_inputs = 0;
+  std::atomic<std::uint64_t> unchanged_files = 0;
+  std::atomic<std::uint64_t> unchanged_objects = 0;
+};  // struct ExtractStats
+
+// Extracts every bundle and serialized file found under the resource root:
+// bundle contents are unpacked, serialized files are split into objects
+// named '<path id>.<class id>', everything else is skipped.
+//
+// Each input is mapped, unpacked, parsed and written by a task of the pool;
+// files of a bundle and blocks of large files are processed by nested tasks.
+// At most '2 * jobs' inputs are in flight. Bundles are mapped by windows
+// covering only files being unpacked, so mapped memory stays bounded.
+//
+// Manifest in the output directory remembers what each input produced.
+// Inputs with the same size and mtime are skipped without mapping. Files
+// of a changed bundle are compared by hash of their packed blocks, so only
+// changed ones are unpacked, and only objects with changed data are written.
+class Extractor {
+ public:
+  explicit Extractor(ExtractOptions options);
+
+  Extractor(const Extractor&) = delete;
+  Extractor& operator=(const Extractor&) = delete;
+
+  // Walks the resource root and waits until everything is written.
+  void Run();
+
+  const ExtractStats& stats() const { return stats_; }
+
+ private:
+  // State of a single input while it's extracted.
+  struct Job {
+    std::filesystem::path path;
+    std::filesystem::path out;
+    std::string key;
+    // record of the previous run, if any
+    const ManifestInput* previous;
+    ManifestInput record;
+    std::mutex mutex;
+    std::atomic<bool> failed = false;
+  };  // struct Job
+
+  void ExtractInput(Job& job);
+  template<typename Source>
+  void ExtractBundle(Job& job, Source&& file);
+  // Standalone serialized file, if 'file' is one.
+  template<typename Source>
+  void ExtractSerialized(Job& job, Source&& file);
+  void ExtractEntry(Job& job, const std::string& name, std::uint64_t hash, std::span<const char> data);
+  template<typename Source>
+  void ExtractAsset(Job& job, const std::string& name, std::uint64_t hash, Source&& source);
+
+  // Returns record of given file from the previous run if its hash is the same.
+  const ManifestEntry* FindUnchanged(const Job& job, const std::string& name, std::uint64_t hash) const;
+  void AddEntry(Job& job, const std::string& name, ManifestEntry entry);
+  // Removes outputs of inputs which don't exist anymore.
+  void RemoveStale();
+
+  // Returns false if the file couldn't be written.
+  bool WriteFile(Job& job, const std::filesystem::path& path, std::span<const char> data);
+  void ReportError(const std::filesystem::path& path, std::string_view message);
+  void ReportError(Job& job, const std::filesystem::path& path, std::string_view message);
+
+  ExtractOptions options_;
+  common::ThreadPool pool_;
+  unity::file::BlockCache cache_;
+  std::counting_semaphore<> in_flight_;
+  std::mutex log_mutex_;
+  Manifest previous_;
+  Manifest current_;
+  std::mutex manifest_mutex_;
+  ExtractStats stats_;
+};  // class Extractor
+
+}  // namespace playground
@@ -1,8 +1,65 @@
 #include <iostream>
 #include <filesystem>
+#include <chrono>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
 
-int main() {
-  std::cout << "Resource root: ";
-  
+#include "extractor.h"
+
+static void PrintUsage() {
+  std::cerr << "usage: playground-app <resource root> <output dir> [--jobs <n>] [--full] [--load] [--queue-depth <n>]\n";
+}
+
+int main(int argc, char** argv) {
+  playground::ExtractOptions options;
+  options.jobs = std::max(1u, std::thread::hardware_concurrency());
+
+  int positional = 0;
+  for (int i = 1; i < argc; ++i) {
+    std::string_view arg = argv[i];
+    if (arg == "--full") {
+      options.incremental = false;
+    } else if (arg == "--load") {
+      options.load = true;
+    } else if (arg == "--queue-depth" && i + 1 < argc) {
+      options.queue_depth = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--jobs" && i + 1 < argc) {
+      options.jobs = std::max(1, std::atoi(argv[++i]));
+    } else if (!arg.starts_with("--") && positional == 0) {
+      options.root = argv[i];
+      ++positional;
+    } else if (!arg.starts_with("--") && positional == 1) {
+      options.output = argv[i];
+      ++positional;
+    } else {
+      PrintUsage();
+      return 1;
+    }
+  }
+  if (positional != 2) {
+    PrintUsage();
+    return 1;
+  }
+
+  std::cout << "Resource root: " << options.root.string() << '\n';
+  std::cout << "Output: " << options.output.string() << " (" << options.jobs << " jobs)\n";
+
+  auto start = std::chrono::steady_clock::now();
+  playground::Extractor extractor{options};
+  extractor.Run();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  auto& stats = extractor.stats();
+  std::cout << "Scanned " << stats.inputs << " files: " 
+            << stats.bundles << " bundles, " << stats.assets << " serialized files\n";
+  std::cout << "Wrote " << stats.files << " files (" << stats.objects << " objects), " 
+            << stats.bytes / (1 << 20) << " MiB in " << elapsed.count() << " s\n";
+  std::cout << "Unchanged since last run: " << stats.unchanged_inputs << " inputs, "
+            << stats.unchanged_files << " files, " << stats.unchanged_objects << " objects\n";
+  if (stats.errors != 0) {
+    std::cout << stats.errors << " errors\n";
+    return 2;
+  }
   return 0;
 }
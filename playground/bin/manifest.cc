@@ -0,0 +1,99 @@
+#include "manifest.h"
+
+#include <charconv>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+
+namespace playground {
+
+// Text format, one record per line; names are last so they may contain spaces:
+//   input <size> <mtime> <path>
+//   entry <hash> <name>                 file of the last input
+//   object <hash> <name>                object of the last entry
+static constexpr std::string_view kSignature = "extract-manifest 2";
+
+namespace {
+
+// Consumes number and a following space from 'line'.
+template<typename T>
+bool ParseField(std::string_view& line, T& value, int base = 10) {
+  auto [ptr, err] = std::from_chars(line.data(), line.data() + line.size(), value, base);
+  if (err != std::errc{} || ptr == line.data() + line.size() || *ptr != ' ') return false;
+  line.remove_prefix(ptr - line.data() + 1);
+  return true;
+}
+
+bool ConsumePrefix(std::string_view& line, std::string_view prefix) {
+  if (!line.starts_with(prefix)) return false;
+  line.remove_prefix(prefix.size());
+  return true;
+}
+
+}  // namespace
+
+std::expected<Manifest, std::string> Manifest::Load(const std::filesystem::path& path) {
+  Manifest ret;
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream) return ret;
+
+  std::string buffer;
+  if (!std::getline(stream, buffer) || buffer != kSignature) 
+    return std::unexpected("Unknown manifest format");
+
+  ManifestInput* input = nullptr;
+  ManifestEntry* entry = nullptr;
+  for (std::size_t line_no = 2; std::getline(stream, buffer); ++line_no) {
+    std::string_view line = buffer;
+    auto error = [&] { return std::unexpected("Malformed manifest line " + std::to_string(line_no)); };
+
+    if (ConsumePrefix(line, "input ")) {
+      ManifestInput cur{};
+      if (!ParseField(line, cur.size) || !ParseField(line, cur.mtime)) return error();
+      input = &(ret.inputs[std::string{line}] = std::move(cur));
+      entry = nullptr;
+    } else if (ConsumePrefix(line, "entry ")) {
+      std::uint64_t hash;
+      if (input == nullptr || !ParseField(line, hash, 16)) return error();
+      entry = &(input->entries[std::string{line}] = ManifestEntry{hash, {}});
+    } else if (ConsumePrefix(line, "object ")) {
+      std::uint64_t hash;
+      if (entry == nullptr || !ParseField(line, hash, 16)) return error();
+      entry->objects[std::string{line}] = hash;
+    } else {
+      return error();
+    }
+  }
+  return ret;
+}
+
+std::optional<std::string> Manifest::Save(const std::filesystem::path& path) const {
+  auto temp = path;
+  temp += ".tmp";
+
+  {
+    std::ofstream stream{temp, std::ios::binary | std::ios::trunc};
+    stream << kSignature << '\n' << std::hex;
+    for (auto& [input_path, input] : inputs) {
+      // such inputs are just extracted again next time
+      if (input_path.find('\n') != std::string::npos) continue;
+
+      stream << "input " << std::dec << input.size << ' ' << input.mtime << ' ' << std::hex << input_path << '\n';
+      for (auto& [entry_name, entry] : input.entries) {
+        // names inside bundles come from the file too
+        if (entry_name.find('\n') != std::string::npos) continue;
+        stream << "entry " << entry.hash << ' ' << entry_name << '\n';
+        for (auto& [object_name, hash] : entry.objects)
+          stream << "object " << hash << ' ' << object_name << '\n';
+      }
+    }
+    if (!stream.flush()) return "Can't write manifest " + temp.string();
+  }
+
+  std::error_code err;
+  std::filesystem::rename(temp, path, err);
+  if (err) return "Can't replace manifest: " + err.message();
+  return std::nullopt;
+}
+
+}  // namespace playground
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace playground {
+
+// Extracted file: a file of a bundle or a standalone serialized file.
+struct ManifestEntry {
+  // hash of packed data which the file was extracted from
+  std::uint64_t hash;
+  // output name of object -> hash of its data; empty if not serialized
+  std::unordered_map<std::string, std::uint64_t> objects;
+};  // struct ManifestEntry
+
+struct ManifestInput {
+  std::uint64_t size;
+  std::int64_t mtime;
+  // keyed by name inside bundle, standalone serialized file has empty name
+  std::map<std::string, ManifestEntry> entries;
+};  // struct ManifestInput
+
+// What was extracted by a previous run, keyed by input path relative
+// to the resource root.
+struct Manifest {
+  std::unordered_map<std::string, ManifestInput> inputs;
+
+  // Reads manifest written by 'Save'; missing file gives an empty one.
+  static std::expected<Manifest, std::string> Load(const std::filesystem::path& path);
+
+  // Replaces 'path' atomically, so interrupted run keeps the old manifest.
+  std::optional<std::string> Save(const std::filesystem::path& path) const;
+};  // struct Manifest
+
+}  // namespace playground
@@ -0,0 +1,26 @@
+#pragma once
+// Minimal checks for test programs: failures are printed and counted,
+// 'main' returns 'test::Result()'.
+
+#include <cstdio>
+
+namespace test {
+
+inline int failures = 0;
+
+inline bool Check(bool ok, const char* expr, const char* file, int line) {
+  if (!ok) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+    ++failures;
+  }
+  return ok;
+}
+
+inline int Result() {
+  if (failures != 0) std::fprintf(stderr, "%d checks failed\n", failures);
+  return failures == 0 ? 0 : 1;
+}
+
+}  // namespace test
+
+#define CHECK(...) ::test::Check(static_cast<bool>(__VA_ARGS__), #__VA_ARGS__, __FILE__, __LINE__)
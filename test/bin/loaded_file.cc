@@ -0,0 +1,63 @@
+// Compares 'LoadedFile::Open' output with the file contents around
+// page and chunk boundaries, for synchronous and queued reads.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <platform/loaded_file.h>
+
+#include "check.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::size_t kPage = 4096;
+constexpr std::size_t kChunk = 64 << 10;
+
+fs::path TempDirectory() {
+  // tmpfs keeps the test off the disk where it is available
+  std::error_code ec;
+  if (fs::is_directory("/dev/shm", ec)) return "/dev/shm";
+  return fs::temp_directory_path();
+}
+
+std::string MakeContent(std::size_t size, unsigned seed) {
+  std::mt19937 rng{seed};
+  std::string content(size, '\0');
+  for (auto& c : content) c = static_cast<char>(rng());
+  return content;
+}
+
+void CheckSize(const fs::path& path, std::size_t size) {
+  auto content = MakeContent(size, static_cast<unsigned>(size));
+  std::ofstream{path, std::ios::binary | std::ios::trunc}.write(content.data(), content.size());
+
+  for (bool async : {false, true}) {
+    for (std::uint32_t queue_depth : {1, 4, 32}) {
+      platform::LoadOptions options{.queue_depth = queue_depth, .chunk_size = kChunk, .async = async};
+      auto file = platform::LoadedFile::Open(path, options);
+      if (!CHECK(file.has_value())) continue;
+      CHECK(file->size() == size);
+      CHECK(std::string_view{static_cast<const char*>(file->data()), file->size()} == content);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  auto path = TempDirectory() / ("loaded_file_test_" + std::to_string(std::random_device{}()));
+  for (std::size_t size : {std::size_t{0}, std::size_t{1}, kPage - 1, kPage, kChunk + 1, 5 * kChunk + kPage + 3})
+    CheckSize(path, size);
+
+  std::error_code ec;
+  fs::remove(path, ec);
+  CHECK(!platform::LoadedFile::Open(path).has_value());
+  return test::Result();
+}
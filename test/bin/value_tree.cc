@@ -0,0 +1,106 @@
+// Decodes objects of synthetic assets in both byte orders by full and
+// projecting plans, then decodes truncated and mutated objects, which
+// may fail but must not read out of bounds.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <unity/file/asset.h>
+#include <unity/type/plan.h>
+#include <unity/type/value.h>
+
+#include "check.h"
+#include "corpus.h"
+
+namespace {
+
+using unity::file::Asset;
+using unity::type::ReadPlan;
+using unity::type::Value;
+using unity::type::ValueTree;
+
+constexpr std::uint32_t kObjects = 50;
+constexpr std::uint32_t kObjectSize = 64;
+constexpr std::uint32_t kSeed = 3;
+
+bool SameValue(const Value& a, const Value& b) {
+  if (a.kind != b.kind || a.size != b.size) return false;
+  switch (a.kind) {
+    case Value::Kind::Int:
+      return a.i == b.i;
+    case Value::Kind::String:
+      return a.string() == b.string();
+    case Value::Kind::Scalars:
+      return a.element == b.element &&
+             std::string_view{static_cast<const char*>(a.data), a.size * unity::type::SizeOf(a.element)} ==
+             std::string_view{static_cast<const char*>(b.data), b.size * unity::type::SizeOf(b.element)};
+    default:
+      return false;
+  }
+}
+
+void CheckAsset(bool big_endian, bool lazy_types) {
+  auto raw = bench::MakeAsset({kObjects, kObjectSize, 1, big_endian}, kSeed);
+  auto asset = Asset::Read(std::span<const char>{raw}, lazy_types);
+  if (!CHECK(asset.has_value())) return;
+  auto tree = asset->types[0].tree();
+  if (!CHECK(tree != nullptr) || !CHECK(asset->object_count == kObjects)) return;
+
+  std::string_view paths[] = {"m_Data", "m_Name", "m_Value"};
+  auto plan = ReadPlan::Project(*tree, paths);
+  CHECK(!plan.error());
+
+  // 'MakeAsset' draws one value per object from the same generator
+  std::mt19937 rng{kSeed};
+  for (std::uint32_t i = 0; i < asset->object_count; ++i) {
+    auto object = asset->GetObject(i);
+    auto value = ValueTree::Decode(*tree, object, asset->header.endian);
+    if (!CHECK(value.has_value())) continue;
+    auto& root = value->root();
+    auto name = value->Find(root, "m_Name");
+    auto number = value->Find(root, "m_Value");
+    auto data = value->Find(root, "m_Data");
+    auto expected = static_cast<std::int32_t>(rng());
+    if (!CHECK(name && number && data)) continue;
+    CHECK(name->string() == "obj_" + std::to_string(i));
+    CHECK(number->kind == Value::Kind::Int && number->i == expected);
+    if (CHECK(data->size == kObjectSize / 4)) {
+      auto floats = data->scalars<float>();
+      for (std::uint32_t j = 0; j < floats.size(); ++j) CHECK(floats[j] == j * 0.5f);
+    }
+
+    auto projected = ValueTree::Decode(plan, *tree, object, asset->header.endian);
+    if (!CHECK(projected.has_value())) continue;
+    auto fields = projected->root().items();
+    if (!CHECK(fields.size() == std::size(paths))) continue;
+    CHECK(SameValue(fields[0], *data));
+    CHECK(SameValue(fields[1], *name));
+    CHECK(SameValue(fields[2], *number));
+  }
+
+  std::mt19937 mutations{1};
+  for (int it = 0; it < 10000; ++it) {
+    auto object = asset->GetObject(it % asset->object_count);
+    std::string copy{object.begin(), object.end()};
+    if (it & 1) {
+      copy.resize(mutations() % copy.size());
+    } else {
+      for (int m = 0; m < 3; ++m) copy[mutations() % copy.size()] = static_cast<char>(mutations());
+    }
+    (void)ValueTree::Decode(*tree, copy, asset->header.endian);
+    (void)ValueTree::Decode(plan, *tree, copy, asset->header.endian);
+  }
+}
+
+}  // namespace
+
+int main() {
+  for (bool big_endian : {false, true}) {
+    for (bool lazy_types : {false, true}) CheckAsset(big_endian, lazy_types);
+  }
+  return test::Result();
+}
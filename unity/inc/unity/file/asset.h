@@ -5,7 +5,10 @@
 #include <string>
 #include <utility>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <variant>
+#include <vector>
 #include <algorithm>
 #include <span>
 
@@ -32,7 +35,7 @@ class Asset {
     platform::Endian endian;
 
     template<common::DataView Source>
-    void Read(common::DataReader<Source>& from);
+    std::optional<std::string> Read(common::DataReader<Source>& from);
   };  // struct Header
   
   struct Object {
@@ -45,8 +48,12 @@ class Asset {
     std::int16_t script_type;
     bool stripped;
 
-    template<common::DataView Source>
-    void Read(common::DataReader<Source>& from, const Asset& asset);
+    // Size of record in object table, not counting alignment.
+    static std::size_t RecordSize(const Asset& asset);
+
+    // 'E' is byte order of the asset, 'asset.header.endian'.
+    template<platform::Endian E, common::DataView Source>
+    std::optional<std::string> Read(common::DataReader<Source>& from, const Asset& asset);
   };  // struct Object
 
   struct ScriptType {
@@ -60,8 +67,61 @@ class Asset {
     const char* path;
   };  // struct FileIdentifier
 
+  // Conditions of 'ObjectTable::Select', all of them must hold.
+  struct ObjectFilter {
+    std::optional<ClassID> class_id;
+    std::uint32_t min_size = 0;
+    std::uint32_t max_size = UINT32_MAX;
+  };  // struct ObjectFilter
+
+  // Objects stored by columns, one contiguous array per field,
+  // so scans over many objects touch only the fields they need.
+  class ObjectTable {
+   public:
+    ObjectTable() = default;
+    explicit ObjectTable(std::uint32_t count);
+    ObjectTable(ObjectTable&& other) noexcept;
+    ObjectTable& operator=(ObjectTable&& other) noexcept;
+
+    std::uint32_t size() const;
+
+    // Gathers fields of object at 'index' from all columns.
+    Object operator[](std::uint32_t index) const;
+    void Set(std::uint32_t index, const Object& object);
+
+    std::span<const std::int64_t> path_ids() const;
+    std::span<const std::uint64_t> offsets() const;
+    std::span<const std::uint32_t> sizes() const;
+    std::span<const std::uint32_t> type_ids() const;
+    std::span<const ClassID> class_ids() const;
+
+    // Appends indices of objects matching 'filter' to 'out' in increasing
+    // order, returns their count. Only 'class_ids' and 'sizes' are read.
+    std::size_t Select(const ObjectFilter& filter, std::vector<std::uint32_t>& out) const;
+    // Same as above, but only counts matching objects.
+    std::size_t Count(const ObjectFilter& filter) const;
+
+   private:
+    template<typename Fn>
+    void ForEachMatch(const ObjectFilter& filter, Fn&& fn) const;
+
+    std::uint32_t size_ = 0;
+    // all columns share one allocation, ordered by decreasing alignment
+    std::unique_ptr<char[]> storage_;
+    std::int64_t* path_ids_ = nullptr;
+    std::uint64_t* offsets_ = nullptr;
+    std::uint32_t* sizes_ = nullptr;
+    std::uint32_t* type_ids_ = nullptr;
+    ClassID* class_ids_ = nullptr;
+    std::uint16_t* destroyed_ = nullptr;
+    std::int16_t* script_types_ = nullptr;
+    bool* stripped_ = nullptr;
+  };  // class ObjectTable
+
+  // With 'lazy_types', type trees are only bounds-checked by the header pass
+  // and parsed by the first call of 'Type::tree'.
   template<common::DataView Source>
-  static std::expected<Asset, std::string> Read(Source&& from);
+  static std::expected<Asset, std::string> Read(Source&& from, bool lazy_types = false);
 
   template<common::DataView Source>
   static bool Detect(Source& from);
@@ -74,7 +134,7 @@ class Asset {
   std::unique_ptr<Type[]> types;
   std::uint32_t big_id_enabled;
   std::uint32_t object_count;
-  std::unique_ptr<Object[]> objects;
+  ObjectTable objects;
   std::uint32_t script_count;
   std::unique_ptr<ScriptType[]> scripts;
   std::uint32_t externals_count;
@@ -85,15 +145,35 @@ class Asset {
 
   std::span<const char> GetObject(std::uint32_t index) const;
 
+  // Returns index of object with 'path_id', first one if it's repeated.
+  // Hash index is built by the first call; it's safe to call concurrently.
+  std::optional<std::uint32_t> FindObject(std::int64_t path_id) const;
+
  private:
+  // Open addressing table of object indices, keys are in 'objects'.
+  struct ObjectIndex {
+    std::once_flag built;
+    std::uint64_t mask = 0;
+    // object index + 1, 0 marks empty slots
+    std::unique_ptr<std::uint32_t[]> slots;
+  };  // struct ObjectIndex
+
   template<common::DataView Source>
   Asset(Source&& from);
 
+  // Reads everything after the header; it's instantiated for both
+  // byte orders, so fields are read without checking the order.
+  template<platform::Endian E, common::DataView Source>
+  std::optional<std::string> ReadMetadata(common::DataReader<Source>& reader, bool lazy_types);
+
   common::Any source_;
+  // lives on heap, as 'once_flag' can't move along with the asset
+  std::unique_ptr<ObjectIndex> index_;
 };  // class Asset
 
 template <common::DataView Source>
-void unity::file::Asset::Header::Read(common::DataReader<Source>& from) {
+std::optional<std::string> unity::file::Asset::Header::Read(common::DataReader<Source>& from) {
+  if (!from.Need(20)) return "Asset header is out of data bounds";
   meta_size = from.template Read<platform::u32be>();
   file_size = from.template Read<platform::u32be>();
   version = from.template Read<platform::u32be>();
@@ -102,140 +182,212 @@ void unity::file::Asset::Header::Read(common::DataReader<Source>& from) {
     endian = from.template Read<std::uint8_t>() ? platform::Endian::B : platform::Endian::L;
     from.position += 3;  // reserved space
   } else {
+    if (meta_size > file_size) return "Asset metadata size is invalid";
     from.position = file_size - meta_size;
+    if (!from.Need(1)) return "Asset header is out of data bounds";
     endian = from.template Read<std::uint8_t>() ? platform::Endian::B : platform::Endian::L;
   }
   if (version >= 22) {
+    if (!from.Need(28)) return "Asset header is out of data bounds";
     meta_size = from.template Read<platform::u64be>();
     file_size = from.template Read<platform::u64be>();
     data_offset = from.template Read<platform::u32be>();
     from.position += 8;
   }
+  return std::nullopt;
 }
 
-template<common::DataView Source>
-void Asset::Object::Read(common::DataReader<Source>& from, const Asset& asset) {
+inline std::size_t Asset::Object::RecordSize(const Asset& asset) {
+  auto version = asset.header.version;
+  std::size_t ret = (asset.big_id_enabled != 0 || version >= 14) ? 8 : 4;  // path_id
+  ret += (version >= 22) ? 8 : 4;  // offset
+  ret += 4 + 4;  // size, type_id
+  if (version < 16) ret += 2;  // class_id
+  if (version < 17) ret += 2;  // destroyed or script_type
+  if (version == 15 || version == 16) ret += 1;  // stripped
+  return ret;
+}
+
+template<platform::Endian E, common::DataView Source>
+std::optional<std::string> Asset::Object::Read(common::DataReader<Source>& from, const Asset& asset) {
+  if (asset.big_id_enabled == 0 && asset.header.version >= 14) 
+    from.AlignTo(4);
+  // whole record is checked once, fields are read unchecked
+  if (!from.Need(RecordSize(asset))) return "Object table is out of data bounds";
+
   if (asset.big_id_enabled != 0) {
-    path_id = from.template Read<platform::i64re>().get(asset.header.endian);
+    path_id = from.template Read<platform::ByteOrdered<std::int64_t, E>>();
   } else if(asset.header.version < 14) {
-    path_id = from.template Read<platform::i32re>().get(asset.header.endian);
+    path_id = from.template Read<platform::ByteOrdered<std::int32_t, E>>();
   } else {
-    from.AlignTo(4);
-    path_id = from.template Read<platform::i64re>().get(asset.header.endian);
+    path_id = from.template Read<platform::ByteOrdered<std::int64_t, E>>();
   }
 
   if (asset.header.version >= 22) {
-    offset = from.template Read<platform::i64re>().get(asset.header.endian);
+    offset = from.template Read<platform::ByteOrdered<std::int64_t, E>>();
   } else {
-    offset = from.template Read<platform::u32re>().get(asset.header.endian);
+    offset = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
   }
-  size = from.template Read<platform::u32re>().get(asset.header.endian);
+  size = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
 
-  type_id = from.template Read<platform::u32re>().get(asset.header.endian);
+  type_id = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
   if (asset.header.version < 16) {
-    class_id = (ClassID)from.template Read<platform::u16re>().get(asset.header.endian);
+    class_id = (ClassID)static_cast<std::uint16_t>(from.template Read<platform::ByteOrdered<std::uint16_t, E>>());
   } else {
+    if (type_id >= asset.type_count) return "Object type index is out of bounds";
     class_id = asset.types[type_id].class_id;
   }
 
   if (asset.header.version < 11) {
-    destroyed = from.template Read<platform::u16re>().get(asset.header.endian);
+    destroyed = from.template Read<platform::ByteOrdered<std::uint16_t, E>>();
   } else if(asset.header.version < 17) {
-    script_type = from.template Read<platform::i16re>().get(asset.header.endian);
+    script_type = from.template Read<platform::ByteOrdered<std::int16_t, E>>();
   }
 
   if (asset.header.version == 15 || asset.header.version == 16)
     stripped = (bool)from.template Read<std::uint8_t>();
+  return std::nullopt;
 }
 
 
 template <common::DataView Source>
-std::expected<Asset, std::string> Asset::Read(Source&& from) {
+std::expected<Asset, std::string> Asset::Read(Source&& from, bool lazy_types) {
   Asset data {std::forward<Source>(from)};
   common::DataReader<Source&> reader{data.source_.GetUnchecked<Source>()};
 
-  data.header.Read(reader);
-  // from now on, account for endianness from header
+  auto header_err = data.header.Read(reader);
+  if (header_err) return std::unexpected(*std::move(header_err));
+  // byte order is checked once, everything else is parsed for a known one
+  auto meta_err = (data.header.endian == platform::Endian::B)
+                ? data.template ReadMetadata<platform::Endian::B>(reader, lazy_types)
+                : data.template ReadMetadata<platform::Endian::L>(reader, lazy_types);
+  if (meta_err) return std::unexpected(*std::move(meta_err));
 
-  if (data.header.version >= 7) {
-    data.version = reader.template ReadNullTerm<char>();
+  auto pos = std::exchange(reader.position, data.header.data_offset);
+  data.data = (std::uint8_t*)reader.current();
+  reader.position = pos;
+
+  return std::move(data);
+}
+
+template<platform::Endian E, common::DataView Source>
+std::optional<std::string> Asset::ReadMetadata(common::DataReader<Source>& reader, bool lazy_types) {
+  if (header.version >= 7) {
+    version = reader.template TryReadNullTerm<char>();
+    if (!version) return "Asset version is out of data bounds";
   } else {
-    data.version = nullptr;
+    version = nullptr;
   }
 
-  if (data.header.version >= 8) {
-    using re_platform = platform::RuntimeOrder<TargetPlatform>;
-    data.platform = reader.template Read<re_platform>().get(data.header.endian);
+  std::size_t head_size = 4 + (header.version >= 8 ? 4 : 0) + (header.version >= 13 ? 1 : 0);
+  if (!reader.Need(head_size)) return "Asset metadata is out of data bounds";
+  if (header.version >= 8) {
+    platform = reader.template Read<platform::ByteOrdered<TargetPlatform, E>>();
   } else {
-    data.platform = TargetPlatform::Unknown;
+    platform = TargetPlatform::Unknown;
   }
-  if (data.header.version >= 13) {
-    data.enable_typetree = reader.template Read<std::uint8_t>();
+  if (header.version >= 13) {
+    enable_typetree = reader.template Read<std::uint8_t>();
   } else {
-    data.enable_typetree = false;
+    enable_typetree = false;
   }
 
-  data.type_count = reader.template Read<platform::u32re>().get(data.header.endian);
-  data.types = std::make_unique<Type[]>(data.type_count);
-  for (std::uint32_t i = 0; i < data.type_count; ++i) 
-    data.types[i] = Type::Read(reader, data.header.endian, data.header.version, false, data.enable_typetree);
+  // counts are checked against the smallest possible record
+  // so corrupted ones don't cause huge allocations
+  type_count = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+  if (!reader.Need(type_count, 4)) return "Type count is invalid";
+  types = std::make_unique<Type[]>(type_count);
+  for (std::uint32_t i = 0; i < type_count; ++i) {
+    auto type = Type::Read<E>(reader, header.version, false, enable_typetree, lazy_types);
+    if (!type) return std::move(type.error());
+    types[i] = *std::move(type);
+  }
   
-  if (data.header.version >= 7 && data.header.version < 14) {
-    data.big_id_enabled = reader.template Read<platform::u32re>().get(data.header.endian);
+  if (header.version >= 7 && header.version < 14) {
+    if (!reader.Need(4)) return "Asset metadata is out of data bounds";
+    big_id_enabled = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
   } else {
-    data.big_id_enabled = 0;
+    big_id_enabled = 0;
   }
   
-  data.object_count = reader.template Read<platform::u32re>().get(data.header.endian);
-  data.objects = std::make_unique<Object[]>(data.object_count);
-  for (std::uint32_t i = 0; i < data.object_count; ++i) 
-    data.objects[i].Read(reader, data);
+  if (!reader.Need(4)) return "Object count is out of data bounds";
+  object_count = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+  if (!reader.Need(object_count, Object::RecordSize(*this))) return "Object count is invalid";
+  objects = ObjectTable{object_count};
+  for (std::uint32_t i = 0; i < object_count; ++i) {
+    Object object{};
+    auto err = object.template Read<E>(reader, *this);
+    if (err) return err;
+    objects.Set(i, object);
+  }
 
-  if (data.header.version < 11) {
-    data.script_count = 0;
+  if (header.version < 11) {
+    script_count = 0;
   } else {
-    data.script_count = reader.template Read<platform::u32re>().get(data.header.endian);
-    data.scripts = std::make_unique<ScriptType[]>(data.script_count);
-    for (std::uint32_t i = 0; i < data.script_count; ++i) {
-      data.scripts[i].file_index = reader.template Read<platform::u32re>().get(data.header.endian);
-      if (data.header.version >= 14) {
+    if (!reader.Need(4)) return "Script count is out of data bounds";
+    script_count = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+    std::size_t script_size = (header.version >= 14) ? 12 : 8;
+    if (!reader.Need(script_count, script_size)) return "Script count is invalid";
+    scripts = std::make_unique<ScriptType[]>(script_count);
+    for (std::uint32_t i = 0; i < script_count; ++i) {
+      if (!reader.Need(4)) return "Script table is out of data bounds";
+      scripts[i].file_index = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+      if (header.version >= 14) {
         reader.AlignTo(4);
-        data.scripts[i].index_in_file = reader.template Read<platform::u64re>().get(data.header.endian);        
+        if (!reader.Need(8)) return "Script table is out of data bounds";
+        scripts[i].index_in_file = reader.template Read<platform::ByteOrdered<std::uint64_t, E>>();        
       } else {
-        data.scripts[i].index_in_file = reader.template Read<platform::u32re>().get(data.header.endian);        
+        if (!reader.Need(4)) return "Script table is out of data bounds";
+        scripts[i].index_in_file = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();        
       }
     }
   }
 
-  data.externals_count = reader.template Read<platform::u32re>().get(data.header.endian);
-  data.externals = std::make_unique<FileIdentifier[]>(data.externals_count);
-  for (std::uint32_t i = 0; i < data.externals_count; ++i) {
-    if (data.header.version >= 6)
-      reader.template ReadNullTerm<char>();
-    if (data.header.version >= 5) {
-      data.externals[i].guid = reader.template Read<common::Guid>();
-      data.externals[i].type = (AssetType)reader.template Read<platform::i32re>().get(data.header.endian);
+  if (!reader.Need(4)) return "Externals count is out of data bounds";
+  externals_count = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+  if (!reader.Need(externals_count, 1)) return "Externals count is invalid";
+  externals = std::make_unique<FileIdentifier[]>(externals_count);
+  for (std::uint32_t i = 0; i < externals_count; ++i) {
+    if (header.version >= 6 && !reader.template TryReadNullTerm<char>())
+      return "External is out of data bounds";
+    if (header.version >= 5) {
+      if (!reader.Need(sizeof(common::Guid) + 4)) return "External is out of data bounds";
+      externals[i].guid = reader.template Read<common::Guid>();
+      externals[i].type = (AssetType)static_cast<std::int32_t>(reader.template Read<platform::ByteOrdered<std::int32_t, E>>());
     }
-    data.externals[i].path = reader.template ReadNullTerm<char>();
+    externals[i].path = reader.template TryReadNullTerm<char>();
+    if (!externals[i].path) return "External is out of data bounds";
   }
 
-  if (data.header.version < 20) {
-    data.reftype_count = 0;
+  if (header.version < 20) {
+    reftype_count = 0;
   } else {
-    data.reftype_count = reader.template Read<platform::u32re>().get(data.header.endian);
-    data.reftypes = std::make_unique<Type[]>(data.type_count);
-    for (std::uint32_t i = 0; i < data.reftype_count; ++i) 
-      data.reftypes[i] = Type::Read(reader, data.header.endian, data.header.version, true, data.enable_typetree);
+    if (!reader.Need(4)) return "Reference type count is out of data bounds";
+    reftype_count = reader.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+    if (!reader.Need(reftype_count, 4)) return "Reference type count is invalid";
+    reftypes = std::make_unique<Type[]>(reftype_count);
+    for (std::uint32_t i = 0; i < reftype_count; ++i) {
+      auto type = Type::Read<E>(reader, header.version, true, enable_typetree, lazy_types);
+      if (!type) return std::move(type.error());
+      reftypes[i] = *std::move(type);
+    }
   }
 
-  if (data.header.version >= 5)
-    reader.template ReadNullTerm<char>();  // user information
-
-  auto pos = std::exchange(reader.position, data.header.data_offset);
-  data.data = (std::uint8_t*)reader.current();
-  reader.position = pos;
+  if (header.version >= 5 && !reader.template TryReadNullTerm<char>())  // user information
+    return "User information is out of data bounds";
+
+  // objects are checked here, so 'GetObject' can't point out of the source
+  std::size_t source_size = reader.from.size();
+  if (header.data_offset > source_size) return "Data offset is out of file bounds";
+  std::size_t data_size = source_size - header.data_offset;
+  auto offsets = objects.offsets();
+  auto sizes = objects.sizes();
+  for (std::uint32_t i = 0; i < object_count; ++i) {
+    if (offsets[i] > data_size || sizes[i] > data_size - offsets[i])
+      return "Object " + std::to_string(objects.path_ids()[i]) + " is out of file bounds";
+  }
 
-  return std::move(data);
+  return std::nullopt;
 }
 
 template<common::DataView Source>
@@ -258,7 +410,8 @@ bool Asset::Detect(Source& from) {
 
   if (version >= 7) {
     reader.position += (version < 22) ? 8 : 36;
-    constexpr auto probe_len = 64;
+    if (!reader.Need(1)) return false;
+    const int probe_len = static_cast<int>(std::min<std::size_t>(64, reader.remaining()));
     const char* fullver = reader.template ReadArray<char>(probe_len);
  
     int index = 0;
@@ -281,6 +434,7 @@ bool Asset::Detect(Source& from) {
 template<common::DataView Source>
 Asset::Asset(Source&& from) 
   : source_{common::Any::Make<Source>(std::forward<Source>(from))}
+  , index_{std::make_unique<ObjectIndex>()}
   {}
 
 }  // namespace file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace unity {
+
+namespace file {
+
+// Unpacked bundle blocks, shared between threads and bundles. Least
+// recently used blocks are evicted when total size exceeds the budget.
+class BlockCache {
+ public:
+  using Data = std::shared_ptr<const char[]>;
+
+  explicit BlockCache(std::size_t capacity);
+
+  BlockCache(const BlockCache&) = delete;
+  BlockCache& operator=(const BlockCache&) = delete;
+
+  // Returns unpacked block or null if it's not cached.
+  Data Find(std::uint64_t bundle, std::uint32_t block);
+  // Stores unpacked block of 'size' bytes.
+  void Insert(std::uint64_t bundle, std::uint32_t block, Data data, std::size_t size);
+  // Drops all blocks, counters are kept.
+  void Clear();
+
+  // Budget for total size of blocks.
+  std::size_t capacity() const { return capacity_; }
+  // Total size of currently cached blocks.
+  std::size_t used() const;
+  // Count of successful lookups.
+  std::uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  // Count of failed lookups.
+  std::uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Key {
+    std::uint64_t bundle;
+    std::uint32_t block;
+
+    bool operator==(const Key&) const = default;
+  };  // struct Key
+
+  struct KeyHash {
+    std::size_t operator()(const Key& key) const;
+  };  // struct KeyHash
+
+  struct Entry {
+    Key key;
+    Data data;
+    std::size_t size;
+  };  // struct Entry
+
+  // most recently used first
+  using Order = std::list<Entry>;
+
+  std::size_t capacity_;
+  mutable std::mutex mutex_;
+  std::size_t used_ = 0;
+  Order order_;
+  std::unordered_map<Key, Order::iterator, KeyHash> index_;
+  std::atomic<std::uint64_t> hits_ = 0;
+  std::atomic<std::uint64_t> misses_ = 0;
+};  // class BlockCache
+
+}  // namespace file
+
+}  // namespace unity
@@ -8,14 +8,18 @@
 #include <string>
 #include <optional>
 #include <algorithm>
+#include <functional>
 #include <span>
+#include <type_traits>
 
 #include <common/any.h>
 #include <common/data_reader.h>
+#include <common/thread_pool.h>
 #include <platform/endian.h>
 
 #include <unity/flags.h>
 #include <unity/unpack.h>
+#include <unity/file/block_cache.h>
 
 namespace unity {
 
@@ -34,7 +38,7 @@ struct Bundle {
     ArchiveFlags flags;
 
     template<common::DataView Source>
-    void Read(common::DataReader<Source>& from);
+    std::optional<std::string> Read(common::DataReader<Source>& from);
   };  // struct Header
 
   struct Block {
@@ -71,8 +75,19 @@ struct Bundle {
     File& operator=(File&&) = delete;
   };
 
+  // Range of packed data. Windowed sources lend it on demand,
+  // so it's readable only while the window lives.
+  struct Window {
+    std::span<const char> data;
+    common::Any holder;
+  };  // struct Window
+
   template<common::DataView Source>
   static std::expected<Bundle, std::string> Read(Source&& from);
+  // Same as above, but only header and block info are read from the source
+  // at once; packed blocks are lent by it when they're unpacked.
+  template<common::LendingView Source>
+  static std::expected<Bundle, std::string> Read(Source&& from);
 
   Header header;
   std::uint32_t block_count;
@@ -81,16 +96,89 @@ struct Bundle {
   const Block& block(uint32_t index);
   const File& first_file();
 
+  // Unpacked block info: table of blocks followed by table of files.
+  std::span<const char> block_info() const;
+  // Returns packed data of all blocks which cover unpacked range
+  // [offset; offset + size), nothing is decompressed.
+  std::expected<Window, std::string> PackedData(std::size_t offset, std::size_t size);
+
   std::optional<std::string> UnpackData(std::size_t offset, std::span<char> buffer);
+  // Same as above, but every block is unpacked by a separate task of 'pool'.
+  // Returns the error of the first failed block, if any.
+  std::optional<std::string> UnpackData(std::size_t offset, std::span<char> buffer,
+                                        common::ThreadPool& pool);
+
+  // Returns view of unpacked data directly in the source when range
+  // [offset; offset + size) lies in uncompressed blocks only. Windowed
+  // sources have no such view.
+  std::optional<std::span<const char>> ViewData(std::size_t offset, std::size_t size);
+  // Returns view of unpacked data, copying it into 'storage' only when
+  // some blocks of the range have to be decompressed.
+  std::expected<std::span<const char>, std::string> ReadData(std::size_t offset, std::size_t size,
+                                                             std::unique_ptr<char[]>& storage);
+
+  // Passes unpacked data [offset; offset + size) to 'sink' by parts produced
+  // in 'scratch'. LZMA blocks are decoded incrementally, so memory use
+  // is bounded by 'scratch' and LZMA dictionary, not by the block size.
+  std::optional<std::string> StreamData(std::size_t offset, std::size_t size, 
+                                        std::span<char> scratch, const UnpackSink& sink);
+
+  // Makes partially read blocks go through 'cache'; null disables caching.
+  // Cache must outlive the bundle or be detached from it.
+  void set_cache(BlockCache* cache) { cache_ = cache; }
 
  private:
-  template<common::DataView Source>
+  // Part of a single block which is covered by unpack request.
+  struct Piece {
+    std::uint32_t index;
+    const Block* block;
+    std::span<const char> src;
+    std::size_t begin;  // offset of 'dst' in unpacked block
+    std::span<char> dst;
+  };  // struct Piece
+
+  // Position of a block start in packed and unpacked data.
+  struct BlockOffset {
+    std::uint64_t packed;
+    std::uint64_t unpacked;
+  };  // struct BlockOffset
+
+  template<typename Source>
   Bundle(Source&& from);
 
+  // Unpacks block info and reads tables of blocks and files from it.
+  std::optional<std::string> ReadInfo(std::span<const char> packed_info);
+  // Returns packed data [begin; begin + size), positions are relative to the first block.
+  std::expected<Window, std::string> LendPacked(std::size_t begin, std::size_t size);
+
+  // Returns unique identifier for a new bundle.
+  static std::uint64_t NextId();
+
+  // Fills 'block_offsets_' from the block table.
+  void BuildBlockIndex();
+  // Returns index of block which contains 'offset' of unpacked data,
+  // or 'block_count' if it's out of range.
+  std::uint32_t FindBlock(std::size_t offset) const;
+
+  // Packed data of pieces is kept in 'window', which must outlive them.
+  template<typename Fn>
+  std::optional<std::string> ForEachPiece(std::size_t offset, std::span<char> buffer, 
+                                          Window& window, Fn&& fn);
+  // 'scratch' starts at 'piece.dst' and can be clobbered to avoid allocation.
+  std::optional<std::string> UnpackPiece(const Piece& piece, std::span<char> scratch);
+
   const char* blocks_;
+  // prefix sums of block sizes, 'block_count + 1' entries
+  std::unique_ptr<BlockOffset[]> block_offsets_;
   const char* files_;
-  const char* data_;
+  // start of packed blocks, null when they're lent by 'lend_'
+  const char* data_ = nullptr;
+  std::function<std::expected<Window, std::string>(std::size_t offset, std::size_t size)> lend_;
+  // keeps header strings of windowed source
+  common::Any head_;
   std::unique_ptr<char[]> unpacked_info_;
+  std::uint64_t id_;
+  BlockCache* cache_ = nullptr;
   common::Any source_;
 };  // class Bundle
 
@@ -99,7 +187,8 @@ std::expected<Bundle, std::string> Bundle::Read(Source&& from) {
   Bundle data {std::forward<Source>(from)};
   common::DataReader<Source&> reader{data.source_.GetUnchecked<Source>()};
 
-  data.header.Read(reader);
+  auto header_err = data.header.Read(reader);
+  if (header_err) return std::unexpected(*std::move(header_err));
   if (strcmp(data.header.signature, "UnityFS"))
     return std::unexpected("Unknown bundle signature");
   
@@ -110,62 +199,108 @@ std::expected<Bundle, std::string> Bundle::Read(Source&& from) {
 
   char* packed_info;
   auto src_size = data.header.packed_info_size;
-  auto dst_size = data.header.unpacked_info_size;
   if (data.header.flags << ArchiveFlags::BlocksInfoFromEnd) {
+    if (src_size > reader.from.size()) return std::unexpected("Block info is out of data bounds");
     auto pos = reader.position;
     reader.position = reader.from.size() - src_size;
     packed_info = reader.template ReadArray<char>(src_size);
     reader.position = pos;
   } else if (data.header.flags << ArchiveFlags::BlocksDirInfoCombined) {
+    if (!reader.Need(src_size)) return std::unexpected("Block info is out of data bounds");
     packed_info = reader.template ReadArray<char>(src_size);    
   } else {
     return std::unexpected("Invalid block info positioning in bundle");
   }
 
-  data.unpacked_info_ = std::make_unique<char[]>(dst_size);
+  auto info_err = data.ReadInfo(std::span{packed_info, src_size});
+  if (info_err) return std::unexpected(*std::move(info_err));
 
-  auto compress = static_cast<CompressionType>(data.header.flags & ArchiveFlags::CompressionMask);
-  auto decomp_result = Unpack(compress, std::span{packed_info, src_size}, 
-                                        std::span{data.unpacked_info_.get(), dst_size});
-  if (decomp_result) return std::unexpected(*std::move(decomp_result));
+  if (data.header.flags << ArchiveFlags::BlockInfoWithPadding)
+    reader.AlignTo(16);
 
-  // read blocks
+  if (!reader.Need(data.block_offsets_[data.block_count].packed))
+    return std::unexpected("Bundle data is out of file bounds");
+  data.data_ = reinterpret_cast<const char*>(reader.current());
+  return std::move(data);
+}
 
-  char* info_raw = data.unpacked_info_.get() + 16;
+template<common::LendingView Source>
+std::expected<Bundle, std::string> Bundle::Read(Source&& from) {
+  // header is much smaller, but mapping granularity is a page anyway
+  constexpr std::size_t head_size = 4096;
 
-  data.block_count = *reinterpret_cast<platform::u32be*>(info_raw);
-  data.blocks_ = reinterpret_cast<const char*>(info_raw += 4);
-  info_raw += data.block_count * Block::size_of;
+  Bundle data {std::forward<Source>(from)};
+  auto& source = data.source_.GetUnchecked<Source>();
 
-  // read files
+  auto head = source.Lend(0, head_size);
+  if (!head) return std::unexpected("Can't read bundle header");
+  std::span<const char> head_data{static_cast<const char*>(head->data()), head->size()};
+  common::DataReader<std::span<const char>> reader{head_data};
 
-  data.file_count = *reinterpret_cast<platform::u32be*>(info_raw);
-  data.files_ = (info_raw += 4);
+  auto header_err = data.header.Read(reader);
+  if (header_err) return std::unexpected(*std::move(header_err));
+  if (strcmp(data.header.signature, "UnityFS"))
+    return std::unexpected("Unknown bundle signature");
+  
+  if (data.header.version >= 7)
+    reader.AlignTo(16);
+
+  // unpack data
+
+  std::size_t info_pos;
+  auto src_size = data.header.packed_info_size;
+  if (data.header.flags << ArchiveFlags::BlocksInfoFromEnd) {
+    if (src_size > source.size()) return std::unexpected("Block info is out of data bounds");
+    info_pos = source.size() - src_size;
+  } else if (data.header.flags << ArchiveFlags::BlocksDirInfoCombined) {
+    info_pos = reader.position;
+    reader.position += src_size;
+  } else {
+    return std::unexpected("Invalid block info positioning in bundle");
+  }
+
+  auto info = source.Lend(info_pos, src_size);
+  if (!info || info->size() != src_size) return std::unexpected("Can't read bundle block info");
+  auto info_err = data.ReadInfo({static_cast<const char*>(info->data()), info->size()});
+  if (info_err) return std::unexpected(*std::move(info_err));
 
   if (data.header.flags << ArchiveFlags::BlockInfoWithPadding)
     reader.AlignTo(16);
 
-  data.data_ = reinterpret_cast<const char*>(reader.current());
+  // source lives in 'source_' on heap, so it doesn't move along with the bundle
+  using Holder = std::remove_cvref_t<decltype(*head)>;
+  data.lend_ = [&source, base = reader.position](std::size_t offset, std::size_t size) 
+                -> std::expected<Window, std::string> {
+    auto window = source.Lend(base + offset, size);
+    if (!window || window->size() != size) return std::unexpected("Can't read bundle data");
+    std::span<const char> view{static_cast<const char*>(window->data()), window->size()};
+    return Window{view, common::Any::Make<Holder>(*std::move(window))};
+  };
+  data.head_ = common::Any::Make<Holder>(*std::move(head));
   return std::move(data);
 }
 
-template<common::DataView Source>
+template<typename Source>
 Bundle::Bundle(Source&& from) 
-  : source_{common::Any::Make<Source>(std::forward<Source>(from))}
+  : id_{NextId()}
+  , source_{common::Any::Make<Source>(std::forward<Source>(from))}
   {}
 
 template<common::DataView Source>
-void Bundle::Header::Read(common::DataReader<Source>& from) {
+std::optional<std::string> Bundle::Header::Read(common::DataReader<Source>& from) {
   using flags_be = platform::ByteOrdered<ArchiveFlags, platform::Endian::B>;
 
-  signature = from.template ReadNullTerm<char>();
+  signature = from.template TryReadNullTerm<char>();
+  if (!signature || !from.Need(4)) return "Bundle header is out of data bounds";
   version = from.template Read<platform::u32be>();
-  unity_version = from.template ReadNullTerm<char>();
-  unity_revision = from.template ReadNullTerm<char>();
+  unity_version = from.template TryReadNullTerm<char>();
+  unity_revision = unity_version ? from.template TryReadNullTerm<char>() : nullptr;
+  if (!unity_revision || !from.Need(20)) return "Bundle header is out of data bounds";
   size = from.template Read<platform::u64be>();
   packed_info_size = from.template Read<platform::u32be>();
   unpacked_info_size = from.template Read<platform::u32be>();
   flags = from.template Read<flags_be>();
+  return std::nullopt;
 }
 
 }  // namespace file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <cstdint>
+#include <expected>
+#include <string>
 
 #include <common/data_reader.h>
 
@@ -16,7 +18,7 @@ struct TypeName {
   const char* assembly;
 
   template<common::DataView Source>
-  static TypeName Read(common::DataReader<Source>& from);
+  static std::expected<TypeName, std::string> Read(common::DataReader<Source>& from);
 };  // struct TypeName
 
 template<typename T>
@@ -26,12 +28,13 @@ struct Sized {
 };
 
 template<common::DataView Source>
-TypeName TypeName::Read(common::DataReader<Source>& from) {
-  return {
-    from.template ReadNullTerm<char>(),
-    from.template ReadNullTerm<char>(),
-    from.template ReadNullTerm<char>()
-  };
+std::expected<TypeName, std::string> TypeName::Read(common::DataReader<Source>& from) {
+  TypeName ret;
+  ret.clazz = from.template TryReadNullTerm<char>();
+  ret.namezpace = ret.clazz ? from.template TryReadNullTerm<char>() : nullptr;
+  ret.assembly = ret.namezpace ? from.template TryReadNullTerm<char>() : nullptr;
+  if (!ret.assembly) return std::unexpected("Type name is out of data bounds");
+  return ret;
 }
 
 }  // namespace unity
\ No newline at end of file
@@ -1,50 +1,129 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
+#include <compare>
+#include <expected>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
 #include <variant>
 
 #include <platform/endian.h>
 #include <common/data_reader.h>
 #include <unity/misc.h>
 #include <unity/flags.h>
+#include <unity/type_cache.h>
 
 namespace unity {
 
+namespace type {
+
+class ReadPlan;
+
+}  // namespace type
+
 struct TypeTree {
-  struct Node {
-    std::uint16_t version;
-    std::uint8_t level;
-    std::uint8_t flags;
-    std::int32_t size;
-    std::uint32_t meta_flags;
-    std::uint64_t ref_type_hash;
-
-    union {
-      struct {
-        const char* type;
-        const char* name;
-      };
-      struct {
-        std::uint32_t type_offset;
-        std::uint32_t name_offset;
-      };
-    };
+  // Type and field names are identified by 32-bit ids: offset in common
+  // strings with the high bit set, or offset in 'strings' of the tree.
+  // Local copies of common strings get common ids, so those are equal
+  // in all trees and can be compared instead of strings.
+  static constexpr std::uint32_t kCommonBit = 0x80000000;
+  // Id which no node has.
+  static constexpr std::uint32_t kNoId = 0xFFFFFFFF;
 
+  // Position of a node; mappers walk trees with it in order.
+  class Cursor {
+   public:
+    Cursor() = default;
+    Cursor(const TypeTree* tree, std::uint32_t index);
+
+    std::uint32_t index() const { return index_; }
+    std::uint16_t version() const;
+    std::uint8_t level() const;
+    std::uint8_t flags() const;
+    std::int32_t size() const;
+    std::uint32_t meta_flags() const;
+    std::uint64_t ref_type_hash() const;
+    std::uint32_t type_id() const;
+    std::uint32_t name_id() const;
+    const char* type() const;
+    const char* name() const;
     bool aligned() const;
-  };  // struct Node
 
-  std::uint32_t node_count;
-  std::unique_ptr<Node[]> nodes;
-  const char* strings;
+    // Compares type by 'id' if it's common, otherwise by 'type_name'.
+    bool HasType(std::uint32_t id, std::string_view type_name) const;
+
+    Cursor& operator++();
+    Cursor operator++(int);
+    bool operator==(const Cursor& other) const { return index_ == other.index_; }
+    auto operator<=>(const Cursor& other) const { return index_ <=> other.index_; }
+
+   private:
+    const TypeTree* tree_ = nullptr;
+    std::uint32_t index_ = 0;
+  };  // class Cursor
+
+  TypeTree();
+  TypeTree(TypeTree&& other) noexcept;
+  TypeTree& operator=(TypeTree&& other) noexcept;
+  ~TypeTree();
+
+  std::uint32_t node_count = 0;
+  const char* strings = nullptr;
+
+  Cursor begin() const;
+  Cursor end() const;
+  Cursor node(std::uint32_t index) const;
 
-  const char* GetString(std::uint32_t offset) const;
+  const char* GetString(std::uint32_t id) const;
+  // Returns plan which decodes objects of the tree. It's compiled by the
+  // first call, which is safe to make concurrently; tree must be read.
+  const type::ReadPlan& plan() const;
 
-  template<common::DataView Source>
-  void ReadBlob(common::DataReader<Source>& from, platform::Endian endian, std::uint32_t version);
+  // Checks that 'offset' is within strings of 'string_size' bytes or common ones.
+  static bool HasString(std::uint32_t offset, std::uint32_t string_size);
+  // Returns id of common string equal to 'value', or 'kNoId'.
+  static std::uint32_t CommonId(std::string_view value);
 
-  template<common::DataView Source>
-  void Read(common::DataReader<Source>& from, platform::Endian endian, std::uint32_t version);
+  // Size of serialized node in blob format.
+  static std::size_t NodeSize(std::uint32_t version);
+
+  // Parsers are instantiated per byte order 'E' of the containing file.
+  template<platform::Endian E, common::DataView Source>
+  std::optional<std::string> ReadBlob(common::DataReader<Source>& from, std::uint32_t version);
+
+  // Checks bounds of blob and moves past it without parsing nodes.
+  template<platform::Endian E, common::DataView Source>
+  static std::optional<std::string> SkipBlob(common::DataReader<Source>& from, std::uint32_t version);
+
+  template<platform::Endian E, common::DataView Source>
+  std::optional<std::string> Read(common::DataReader<Source>& from, std::uint32_t version);
+
+ private:
+  // Allocates columns for 'count' nodes; ref type hashes are only kept
+  // by formats which have them.
+  void Allocate(std::uint32_t count, bool with_ref_hashes);
+  // Turns string offsets of nodes into ids, 'string_size' bytes of 'strings' are valid.
+  std::optional<std::string> ResolveIds(std::uint32_t string_size);
+
+  // Plan of the tree, compiled on demand.
+  struct PlanSlot;
+
+  // all columns share one allocation, ordered by decreasing alignment
+  std::unique_ptr<char[]> storage_;
+  std::uint64_t* ref_type_hashes_ = nullptr;
+  std::int32_t* sizes_ = nullptr;
+  std::uint32_t* meta_flags_ = nullptr;
+  std::uint32_t* type_ids_ = nullptr;
+  std::uint32_t* name_ids_ = nullptr;
+  std::uint16_t* versions_ = nullptr;
+  // level in the low byte, flags in the high one
+  std::uint16_t* shapes_ = nullptr;
+  // lives on heap, as 'once_flag' can't move along with the tree
+  std::unique_ptr<PlanSlot> plan_;
 };  // struct TypeTree
 
 struct Type {
@@ -53,64 +132,111 @@ struct Type {
   std::int16_t script_type_index;
   Hash128 script_id;
   Hash128 old_type_hash;
-  TypeTree tree;
   std::variant<TypeName, Sized<platform::u32re>> depends;
 
-  template<common::DataView Source>
-  static Type Read(common::DataReader<Source>& from, 
-                   platform::Endian endian, 
-                   std::uint32_t version, 
-                   bool is_ref, bool use_typetree);
-};  // struct Type
+  // Returns null when file has no type trees. Lazily read tree is parsed
+  // by the first call, which is safe to make concurrently; null is also
+  // returned if it turns out to be malformed. Trees are immutable and
+  // shared through 'TypeTreeCache::Global' with equal types of other files.
+  const TypeTree* tree() const;
+
+  // With 'lazy', blob of type tree is only bounds-checked and skipped.
+  template<platform::Endian E, common::DataView Source>
+  static std::expected<Type, std::string> Read(common::DataReader<Source>& from, 
+                                              std::uint32_t version, 
+                                              bool is_ref, bool use_typetree,
+                                              bool lazy = false);
 
-template<common::DataView Source>
-void TypeTree::Read(common::DataReader<Source>& from, platform::Endian endian, std::uint32_t version) {
-  assert(false && "TODO");
-}
-
-template<common::DataView Source>
-void TypeTree::ReadBlob(common::DataReader<Source>& from, platform::Endian endian, std::uint32_t version) {
-  node_count = from.template Read<platform::u32re>().get(endian);
-  auto string_size = from.template Read<platform::u32re>().get(endian);
-  nodes = std::make_unique<Node[]>(node_count);
-  for (std::uint32_t i = 0; i < node_count; ++i) {
-    nodes[i].version = from.template Read<platform::u16re>().get(endian);
-    nodes[i].level = from.template Read<std::uint8_t>();
-    nodes[i].flags = from.template Read<std::uint8_t>();
-    nodes[i].type_offset = from.template Read<platform::u32re>().get(endian);
-    nodes[i].name_offset = from.template Read<platform::u32re>().get(endian);
-    nodes[i].size = from.template Read<platform::i32re>().get(endian);
-    auto _ = from.template Read<platform::u32re>();  // "index" is not stored
-    nodes[i].meta_flags = from.template Read<platform::u32re>().get(endian);
-    if (version > 19) {
-      nodes[i].ref_type_hash = from.template Read<platform::u64re>().get(endian);
+ private:
+  // Parsing state of the tree: 'kParsed' when 'tree_' is final, otherwise
+  // 'pending_blob_' is parsed by the first 'tree' call.
+  enum : std::uint8_t { kParsed, kPending, kParsing };
+
+  // Atomic state which moves along with the type; types are only moved
+  // while being read, before anyone can call 'tree'.
+  struct State {
+    mutable std::atomic<std::uint8_t> value{kParsed};
+
+    State() = default;
+    State(State&& other) : value{other.value.load(std::memory_order_relaxed)} {}
+    State& operator=(State&& other) {
+      value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      return *this;
     }
+  };  // struct State
+
+  // set by 'tree' for pending one
+  mutable TypeTreeCache::Tree tree_;
+  // kept inline, so lazy types cost no allocations until parsed
+  std::span<const char> pending_blob_;
+  std::uint32_t pending_version_ = 0;
+  platform::Endian pending_endian_ = platform::Endian::L;
+  State state_;
+};  // struct Type
+
+template<platform::Endian E, common::DataView Source>
+std::optional<std::string> TypeTree::Read(common::DataReader<Source>&, std::uint32_t) {
+  return "Legacy TypeTree format is not supported";
+}
+
+template<platform::Endian E, common::DataView Source>
+std::optional<std::string> TypeTree::ReadBlob(common::DataReader<Source>& from, std::uint32_t version) {
+  if (!from.Need(8)) return "TypeTree header is out of data bounds";
+  auto count = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+  auto string_size = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+
+  // all nodes are checked at once, then read without checks
+  if (!from.Need(count, NodeSize(version))) return "TypeTree nodes are out of data bounds";
+  Allocate(count, version > 19);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    versions_[i] = from.template Read<platform::ByteOrdered<std::uint16_t, E>>();
+    std::uint16_t level = from.template Read<std::uint8_t>();
+    std::uint16_t flags = from.template Read<std::uint8_t>();
+    shapes_[i] = level | (flags << 8);
+    // offsets until strings are resolved
+    type_ids_[i] = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+    name_ids_[i] = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+    sizes_[i] = from.template Read<platform::ByteOrdered<std::int32_t, E>>();
+    from.position += 4;  // "index" is not stored
+    meta_flags_[i] = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+    if (ref_type_hashes_)
+      ref_type_hashes_[i] = from.template Read<platform::ByteOrdered<std::uint64_t, E>>();
   }
+
+  if (!from.Need(string_size)) return "TypeTree strings are out of data bounds";
   strings = from.template ReadArray<char>(string_size);
-  for (std::uint32_t i = 0; i < node_count; ++i) {
-    auto type_offset = nodes[i].type_offset;
-    auto name_offset = nodes[i].name_offset;
-    // don't reorder - these fields are in 'union'
-    nodes[i].type = GetString(type_offset);
-    nodes[i].name = GetString(name_offset);
-  }
+  return ResolveIds(string_size);
+}
+
+template<platform::Endian E, common::DataView Source>
+std::optional<std::string> TypeTree::SkipBlob(common::DataReader<Source>& from, std::uint32_t version) {
+  if (!from.Need(8)) return "TypeTree header is out of data bounds";
+  std::uint32_t node_count = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+  std::uint32_t string_size = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+  if (!from.Need(node_count, NodeSize(version))) return "TypeTree nodes are out of data bounds";
+  from.position += node_count * NodeSize(version);
+  if (!from.Need(string_size)) return "TypeTree strings are out of data bounds";
+  from.position += string_size;
+  return std::nullopt;
 }
 
-template<common::DataView Source>
-Type Type::Read(common::DataReader<Source>& from, 
-                platform::Endian endian, 
-                std::uint32_t version, 
-                bool is_ref, bool use_typetree) {
+template<platform::Endian E, common::DataView Source>
+std::expected<Type, std::string> Type::Read(common::DataReader<Source>& from, 
+                                            std::uint32_t version, 
+                                            bool is_ref, bool use_typetree,
+                                            bool lazy) {
 
   Type ret;
-  ret.class_id = (ClassID)from.template Read<platform::u32re>().get(endian);
+  std::size_t head_size = 4 + (version >= 16 ? 1 : 0) + (version >= 17 ? 2 : 0);
+  if (!from.Need(head_size)) return std::unexpected("Type is out of data bounds");
+  ret.class_id = (ClassID)static_cast<std::uint32_t>(from.template Read<platform::ByteOrdered<std::uint32_t, E>>());
   if (version >= 16) {
     ret.is_stripped = from.template Read<std::uint8_t>();
   } else {
     ret.is_stripped = false;
   }
   if (version >= 17) {
-    ret.script_type_index = from.template Read<platform::i16re>().get(endian);
+    ret.script_type_index = from.template Read<platform::ByteOrdered<std::int16_t, E>>();
   } else {
     ret.script_type_index = -1;
   }
@@ -118,22 +244,48 @@ Type Type::Read(common::DataReader<Source>& from,
     bool has_script = (version < 16) 
                     ? (ret.class_id < (ClassID)0) 
                     : (ret.class_id == ClassID::MonoBehaviour);
-    if ((is_ref && ret.script_type_index >= 0) || has_script)
+    bool with_script_id = (is_ref && ret.script_type_index >= 0) || has_script;
+    if (!from.Need(with_script_id ? 2 : 1, sizeof(Hash128))) 
+      return std::unexpected("Type hashes are out of data bounds");
+    if (with_script_id)
       ret.script_id = from.template Read<Hash128>();
     ret.old_type_hash = from.template Read<Hash128>();
+  } else {
+    ret.old_type_hash = {};
   }
 
   if (use_typetree) {
     if (version >= 12 || version == 10) {
-      ret.tree.ReadBlob(from, endian, version);
+      auto begin = static_cast<const char*>(from.current());
+      auto err = TypeTree::SkipBlob<E>(from, version);
+      if (err) return std::unexpected(*std::move(err));
+      std::span<const char> blob{begin, static_cast<const char*>(from.current())};
+      if (lazy) {
+        ret.pending_blob_ = blob;
+        ret.pending_version_ = version;
+        ret.pending_endian_ = E;
+        ret.state_.value.store(kPending, std::memory_order_relaxed);
+      } else {
+        auto tree = TypeTreeCache::Global().Intern(ret.old_type_hash, version, E, blob);
+        if (!tree) return std::unexpected(std::move(tree.error()));
+        ret.tree_ = *std::move(tree);
+      }
     } else {
-      ret.tree.Read(from, endian, version);
+      auto tree = std::make_shared<TypeTree>();
+      auto err = tree->template Read<E>(from, version);
+      if (err) return std::unexpected(*std::move(err));
+      ret.tree_ = std::move(tree);
     }
     if (version >= 21) {
       if (is_ref) {
-        ret.depends = TypeName::Read(from);
+        auto name = TypeName::Read(from);
+        if (!name) return std::unexpected(std::move(name.error()));
+        ret.depends = *name;
       } else {
-        auto size = from.template Read<platform::u32re>().get(endian);
+        if (!from.Need(4)) return std::unexpected("Type dependencies are out of data bounds");
+        auto size = from.template Read<platform::ByteOrdered<std::uint32_t, E>>();
+        if (!from.Need(size, sizeof(platform::u32re))) 
+          return std::unexpected("Type dependencies are out of data bounds");
         ret.depends = Sized<platform::u32re> {
           size,
           from.template ReadArray<platform::u32re>(size)
@@ -147,8 +299,81 @@ Type Type::Read(common::DataReader<Source>& from,
   return ret;
 }
 
-inline bool TypeTree::Node::aligned() const {
-  return meta_flags & 0x4000;
+inline TypeTree::Cursor::Cursor(const TypeTree* tree, std::uint32_t index)
+  : tree_{tree}
+  , index_{index}
+  {}
+
+inline std::uint16_t TypeTree::Cursor::version() const {
+  return tree_->versions_[index_];
+}
+
+inline std::uint8_t TypeTree::Cursor::level() const {
+  return static_cast<std::uint8_t>(tree_->shapes_[index_]);
+}
+
+inline std::uint8_t TypeTree::Cursor::flags() const {
+  return static_cast<std::uint8_t>(tree_->shapes_[index_] >> 8);
+}
+
+inline std::int32_t TypeTree::Cursor::size() const {
+  return tree_->sizes_[index_];
+}
+
+inline std::uint32_t TypeTree::Cursor::meta_flags() const {
+  return tree_->meta_flags_[index_];
+}
+
+inline std::uint64_t TypeTree::Cursor::ref_type_hash() const {
+  return tree_->ref_type_hashes_ ? tree_->ref_type_hashes_[index_] : 0;
+}
+
+inline std::uint32_t TypeTree::Cursor::type_id() const {
+  return tree_->type_ids_[index_];
+}
+
+inline std::uint32_t TypeTree::Cursor::name_id() const {
+  return tree_->name_ids_[index_];
+}
+
+inline const char* TypeTree::Cursor::type() const {
+  return tree_->GetString(type_id());
+}
+
+inline const char* TypeTree::Cursor::name() const {
+  return tree_->GetString(name_id());
+}
+
+inline bool TypeTree::Cursor::aligned() const {
+  return meta_flags() & 0x4000;
+}
+
+inline bool TypeTree::Cursor::HasType(std::uint32_t id, std::string_view type_name) const {
+  if (id != kNoId) return type_id() == id;
+  return type() == type_name;
+}
+
+inline TypeTree::Cursor& TypeTree::Cursor::operator++() {
+  ++index_;
+  return *this;
+}
+
+inline TypeTree::Cursor TypeTree::Cursor::operator++(int) {
+  Cursor ret = *this;
+  ++index_;
+  return ret;
+}
+
+inline TypeTree::Cursor TypeTree::begin() const {
+  return {this, 0};
+}
+
+inline TypeTree::Cursor TypeTree::end() const {
+  return {this, node_count};
+}
+
+inline TypeTree::Cursor TypeTree::node(std::uint32_t index) const {
+  return {this, index};
 }
 
 }  // namespace unity
\ No newline at end of file
@@ -16,7 +16,7 @@ namespace type {
 
 template<Mapper T, std::size_t Count>
 struct FixedArray {
-  static bool Verify(const TypeTree::Node*& current, const TypeTree::Node* end);
+  static bool Verify(TypeTree::Cursor& current, TypeTree::Cursor end);
   FixedArray(MapReader& raw, platform::Endian order);
 
   std::array<T, Count> data;
@@ -25,7 +25,7 @@ struct FixedArray {
 template<Mapper T>
 class Array {
  public:
-  static bool Verify(const TypeTree::Node*& current, const TypeTree::Node* end);
+  static bool Verify(TypeTree::Cursor& current, TypeTree::Cursor end);
   Array(MapReader& raw, platform::Endian order);
 
   Array(const Array&) = delete;
@@ -42,7 +42,7 @@ class Array {
 };  // struct Array
 
 struct TypelessData {
-  static bool Verify(const TypeTree::Node*& current, const TypeTree::Node* end);
+  static bool Verify(TypeTree::Cursor& current, TypeTree::Cursor end);
   TypelessData(MapReader& raw, platform::Endian order);
 
   Int size;
@@ -52,11 +52,11 @@ struct TypelessData {
 
 
 template<Mapper T, std::size_t Count>
-bool FixedArray<T, Count>::Verify(const TypeTree::Node*& current, const TypeTree::Node* end) {
+bool FixedArray<T, Count>::Verify(TypeTree::Cursor& current, TypeTree::Cursor end) {
   if (current >= end) return false;
-  auto level = current->level;
+  auto level = current.level();
   for (std::size_t i = 0; i < Count; ++i) {
-    if (current->level != level || current->aligned() || !T::Verify(current, end)) 
+    if (current >= end || current.level() != level || current.aligned() || !T::Verify(current, end)) 
       return false;
   }
   return true;
@@ -78,23 +78,49 @@ FixedArray<T, Count>::FixedArray(MapReader& raw, platform::Endian order)
   {}
 
 template<Mapper T>
-bool Array<T>::Verify(const TypeTree::Node*& current, const TypeTree::Node* end) {
+bool Array<T>::Verify(TypeTree::Cursor& current, TypeTree::Cursor end) {
+  static const std::uint32_t type_id = TypeTree::CommonId("Array");
   if (current >= end) return false;
-  if (current->type != (std::string_view)"Array") return false;
+  if (!current.HasType(type_id, "Array")) return false;
   
-  auto level = current++->level + 1;
-  if (current->level != level || current->aligned() || !Int::Verify(current, end)) return false;
-  if (current->level != level || current->aligned() || !T::Verify(current, end)) return false;
+  auto level = current++.level() + 1;
+  if (current >= end || current.level() != level || current.aligned() || !Int::Verify(current, end)) return false;
+  if (current >= end || current.level() != level || current.aligned() || !T::Verify(current, end)) return false;
   return true;
 }
 
+namespace _impl {
+
+// Returns count of elements to read for array of 'size'. Negative sizes and
+// ones which can't fit into data give an empty array, and the rest of data
+// is skipped, so corrupted sizes allocate and read nothing.
+template<Mapper T>
+std::size_t ArrayCount(MapReader& raw, Int& size) {
+  std::size_t min_size = 1;
+  if constexpr (BulkValue<T>) min_size = sizeof(typename T::Stored);
+  if (size.value >= 0 && raw.Need(size.value, min_size)) return size.value;
+
+  size.value = 0;
+  raw.position = raw.from.size();
+  return 0;
+}
+
+}  // namespace _impl
+
 template<Mapper T>
 Array<T>::Array(MapReader& raw, platform::Endian order) 
   : size{Int(raw, order)}
-  , data_{std::make_unique<common::Uninit<T>[]>(size.value)}
+  , data_{std::make_unique_for_overwrite<common::Uninit<T>[]>(_impl::ArrayCount<T>(raw, size))}
 {
-  for (std::size_t i = 0; i < size; ++i)
-    data_[i].Construct(raw, order);
+  if constexpr (_impl::BulkValue<T>) {
+    using Stored = typename T::Stored;
+    std::size_t count = size.value;
+    auto src = raw.template ReadArray<platform::RuntimeOrder<Stored>>(count);
+    platform::ConvertSpan<Stored>({src, count}, {reinterpret_cast<Stored*>(data_.get()), count}, order);
+  } else {
+    for (std::size_t i = 0; i < size; ++i)
+      data_[i].Construct(raw, order);
+  }
 }
 
 template<Mapper T>
@@ -108,13 +134,14 @@ T* Array<T>::data() {
   return reinterpret_cast<T*>(data_.get());
 }
 
-inline bool TypelessData::Verify(const TypeTree::Node*& current, const TypeTree::Node* end) {
+inline bool TypelessData::Verify(TypeTree::Cursor& current, TypeTree::Cursor end) {
+  static const std::uint32_t type_id = TypeTree::CommonId("TypelessData");
   if (current >= end) return false;
-  if (current->type != (std::string_view)"TypelessData") return false;
+  if (!current.HasType(type_id, "TypelessData")) return false;
   
-  auto level = current++->level + 1;
-  if (current->level != level  || current->aligned() || !Int::Verify(current, end)) return false;
-  if (current->level != level  || current->aligned() || !UInt8::Verify(current, end)) return false;
+  auto level = current++.level() + 1;
+  if (current >= end || current.level() != level  || current.aligned() || !Int::Verify(current, end)) return false;
+  if (current >= end || current.level() != level  || current.aligned() || !UInt8::Verify(current, end)) return false;
   return true;
 }
 
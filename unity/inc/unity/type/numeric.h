@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <type_traits>
 
 #include <common/tstring.h>
 
@@ -14,7 +15,9 @@ namespace _impl {
 
 template<auto Name, typename Read, typename Cast = Read>
 struct BasicValue {
-  static bool Verify(const TypeTree::Node*& current, const TypeTree::Node* end);
+  using Stored = Read;
+
+  static bool Verify(TypeTree::Cursor& current, TypeTree::Cursor end);
 
   BasicValue(MapReader& raw, platform::Endian order);
   operator Cast() const;
@@ -22,6 +25,13 @@ struct BasicValue {
   Cast value;
 };  // struct BasicValue
 
+// Values which keep exactly what is stored, so arrays of them
+// are converted all at once instead of one by one.
+template<typename T>
+concept BulkValue = requires { typename T::Stored; } 
+                 && std::is_same_v<typename T::Stored, decltype(T::value)>
+                 && sizeof(T) == sizeof(typename T::Stored);
+
 } // namespace _impl
 
 using namespace common::use;
@@ -42,10 +52,10 @@ using Bool = _impl::BasicValue<"bool"_t, std::uint8_t, bool>;
 
 template<auto Name, typename Read, typename Cast>
 bool _impl::BasicValue<Name, Read, Cast>::Verify(
-    const TypeTree::Node*& current, 
-    const TypeTree::Node* end) {
-  
-  return (current < end) && (current++->type == Name.view());
+    TypeTree::Cursor& current, 
+    TypeTree::Cursor end) {
+  static const std::uint32_t type_id = TypeTree::CommonId(Name.view());
+  return (current < end) && current++.HasType(type_id, Name.view());
 }
 
 template <auto Name, typename Read, typename Cast>
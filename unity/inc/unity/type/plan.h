@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <platform/endian.h>
+
+#include <unity/type.h>
+#include <unity/type/value.h>
+
+namespace unity {
+
+namespace type {
+
+// Flat program which decodes objects of one type tree into 'Value's.
+// Layout decisions are made once by 'Compile': adjacent primitive fields
+// are read as one run, alignment points are explicit and arrays are loops
+// over the plan of their element.
+class ReadPlan {
+ public:
+  // Compiles plan for values of the root node of 'tree'.
+  static ReadPlan Compile(const TypeTree& tree);
+  // Compiles plan which decodes only fields at 'paths' from the root node,
+  // like "m_Name" or "m_Script.m_PathID"; root value is an object of these
+  // fields in order of 'paths'. Fixed-size fields in between are skipped
+  // at once, arrays by their size, and nothing after the last field is read.
+  static ReadPlan Project(const TypeTree& tree, std::span<const std::string_view> paths);
+
+  // Set when the tree has a layout which can't be decoded.
+  const std::optional<std::string>& error() const { return error_; }
+  // Count of operations, runs of fields take one.
+  std::size_t size() const { return ops_.size(); }
+  // Whether the plan is made by 'Project'.
+  bool projection() const { return targets_ != 0; }
+
+  // Decodes 'data' stored in 'order' into 'out', values are allocated
+  // from 'arena'. 'tree' is the one plan was compiled from.
+  std::optional<std::string> Execute(const TypeTree& tree, std::span<const char> data,
+                                     platform::Endian order, std::pmr::memory_resource& arena,
+                                     Value& out) const;
+
+ private:
+  // Primitive field of a run.
+  struct Field {
+    std::uint32_t node;
+    std::uint32_t offset;  // from the start of the run
+    Scalar type;
+  };  // struct Field
+
+  struct Op {
+    enum class Code : std::uint8_t {
+      Fields,     // 'count' fields from 'first' in 'fields_', 'bytes' in total
+      Align,      // to 4 bytes
+      Object,     // 'count' fields produced by next 'body' ops
+      Array,      // elements produced by next 'body' ops, once per element of at least 'bytes'
+      Scalars,    // array of primitive 'type' elements, read at once
+      Skip,       // 'bytes' of data
+      SkipArray,  // array of elements of 'bytes'
+      Repeat,     // next 'body' ops, once per element of at least 'bytes', which produce nothing
+      Target,     // next values are stored to field 'first' of projection
+    };  // enum class Code
+
+    Code code;
+    Scalar type = Scalar::None;
+    // arrays: size is followed by alignment
+    bool size_aligned = false;
+    // 'Scalars': kind of produced value
+    Value::Kind kind = Value::Kind::Scalars;
+    // node of produced value
+    std::uint32_t node = 0;
+    // node of array, for error messages
+    std::uint32_t array = 0;
+    std::uint32_t count = 0;
+    std::uint32_t body = 0;
+    std::uint32_t first = 0;
+    std::uint32_t bytes = 0;
+  };  // struct Op
+
+  template<platform::Endian E>
+  class Executor;
+  class Compiler;
+
+  std::vector<Op> ops_;
+  std::vector<Field> fields_;
+  std::optional<std::string> error_;
+  // count of projected fields, 0 for plans of whole values
+  std::uint32_t targets_ = 0;
+};  // class ReadPlan
+
+}  // namespace type
+
+}  // namespace unity
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <span>
 #include <concepts>
 #include <utility>
@@ -17,8 +18,8 @@ namespace type {
 using MapReader = common::DataReader<std::span<const char>>;
 
 template<typename This>
-concept Mapper = requires(const TypeTree::Node* current,
-                          const TypeTree::Node* end,
+concept Mapper = requires(TypeTree::Cursor& current,
+                          TypeTree::Cursor end,
                           MapReader& raw,
                           const platform::Endian order) {
   { This::Verify(current, end) } -> std::convertible_to<bool>;
@@ -39,7 +40,7 @@ T Read(MapReader& raw, platform::Endian order) {
 #define _URT_FIELDS_1_END
 #define _URT_FIELDS_2_END
 
-#define _URT_CHECKER(f_align, ...) if ((current->level != level) || (current->aligned() != f_align) || !__VA_ARGS__::Verify(current, end)) return false;
+#define _URT_CHECKER(f_align, ...) if ((current >= end) || (current.level() != level) || (current.aligned() != f_align) || !__VA_ARGS__::Verify(current, end)) return false;
 #define _URT_CHECKERS(data) CONCAT(_URT_CHECKERS_1 data, _END)
 #define _URT_CHECKERS_1(_, f_align, ...) _URT_CHECKER(f_align, __VA_ARGS__) _URT_CHECKERS_2
 #define _URT_CHECKERS_2(_, f_align, ...) _URT_CHECKER(f_align, __VA_ARGS__) _URT_CHECKERS_1
@@ -58,13 +59,14 @@ T Read(MapReader& raw, platform::Endian order) {
 #define UNITY_REGULAR_TYPE(type_name, name, data) struct type_name { \
   _URT_FIELDS(data) \
   \
-  static bool Verify(const ::unity::TypeTree::Node*& current, \
-                     const ::unity::TypeTree::Node* end) { \
+  static bool Verify(::unity::TypeTree::Cursor& current, \
+                     ::unity::TypeTree::Cursor end) { \
+    static const std::uint32_t type_id = ::unity::TypeTree::CommonId(name); \
     \
     if (current >= end) return false; \
-    if (current->type != (std::string_view)(name)) return false; \
+    if (!current.HasType(type_id, name)) return false; \
     \
-    auto level = current++->level + 1; \
+    auto level = current++.level() + 1; \
     _URT_CHECKERS(data) \
     return true; \
   } \
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <expected>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <platform/endian.h>
+
+#include <unity/type.h>
+
+namespace unity {
+
+namespace type {
+
+// Primitive types of tree nodes.
+enum class Scalar : std::uint8_t {
+  None,  // not a primitive
+  Bool,
+  Char,
+  SInt8,
+  UInt8,
+  SInt16,
+  UInt16,
+  SInt32,
+  UInt32,
+  SInt64,
+  UInt64,
+  Float,
+  Double
+};  // enum class Scalar
+
+// Returns primitive type of 'node' by its type name.
+Scalar ScalarOf(const TypeTree::Cursor& node);
+// Returns size of a stored primitive, 0 for 'None'.
+std::size_t SizeOf(Scalar type);
+
+class ReadPlan;
+
+// Field of an object decoded by its type tree. Values are immutable
+// and live in the arena of 'ValueTree' which produced them.
+struct Value {
+  enum class Kind : std::uint8_t {
+    Bool,
+    Int,      // signed integers and 'char'
+    UInt,
+    Float,    // 'float' and 'double'
+    String,   // 'string' and other arrays of 'char'
+    Bytes,    // 'TypelessData'
+    Array,    // elements of any type
+    Scalars,  // primitive elements of type 'element', in native order
+    Object,   // fields in tree order
+  };  // enum class Kind
+
+  Kind kind;
+  Scalar element;
+  // index of the field node in the tree, gives its name and type
+  std::uint32_t node;
+  // count of elements, fields or bytes
+  std::uint32_t size;
+  union {
+    bool b;
+    std::int64_t i;
+    std::uint64_t u;
+    double f;
+    const char* bytes;
+    const Value* children;
+    const void* data;
+  };
+
+  // Bytes of 'String' and 'Bytes'.
+  std::string_view string() const;
+  // Elements of 'Array' or fields of 'Object'.
+  std::span<const Value> items() const;
+  // Elements of 'Scalars', 'T' must be the native type of 'element',
+  // 'std::uint8_t' for 'Bool'.
+  template<typename T>
+  std::span<const T> scalars() const;
+};  // struct Value
+
+// Object decoded by its type tree into 'Value's. Every value is allocated
+// from a monotonic arena of the tree, which is released at once with it.
+class ValueTree {
+ public:
+  // Decodes 'data' stored in 'order'. Strings and bytes point into 'data'
+  // and names into 'tree', so both must outlive the result.
+  static std::expected<ValueTree, std::string> Decode(const TypeTree& tree, std::span<const char> data,
+                                                      platform::Endian order);
+  // Same with 'plan' compiled from 'tree', like a projection of some fields.
+  static std::expected<ValueTree, std::string> Decode(const ReadPlan& plan, const TypeTree& tree,
+                                                      std::span<const char> data, platform::Endian order);
+
+  const Value& root() const { return *root_; }
+
+  // Returns field name of 'value'.
+  const char* name(const Value& value) const;
+  // Returns type name of 'value'.
+  const char* type(const Value& value) const;
+  // Returns field of 'object' with 'name', or null.
+  const Value* Find(const Value& object, std::string_view name) const;
+
+ private:
+  ValueTree(const TypeTree& tree, std::size_t initial_size);
+
+  const TypeTree* tree_;
+  // values point into it, so it's kept on heap to move with them
+  std::unique_ptr<std::pmr::monotonic_buffer_resource> arena_;
+  const Value* root_ = nullptr;
+};  // class ValueTree
+
+inline std::string_view Value::string() const {
+  return {bytes, size};
+}
+
+inline std::span<const Value> Value::items() const {
+  return {children, size};
+}
+
+template<typename T>
+std::span<const T> Value::scalars() const {
+  return {static_cast<const T*>(data), size};
+}
+
+}  // namespace type
+
+}  // namespace unity
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+#include <platform/endian.h>
+#include <unity/misc.h>
+
+namespace unity {
+
+struct TypeTree;
+
+// Immutable type trees shared between types of all assets. Trees are keyed
+// by type hash and serialized blob, so equal ones are parsed only once.
+// Table doesn't own trees: they live while some type refers to them.
+class TypeTreeCache {
+ public:
+  using Tree = std::shared_ptr<const TypeTree>;
+
+  TypeTreeCache() = default;
+
+  TypeTreeCache(const TypeTreeCache&) = delete;
+  TypeTreeCache& operator=(const TypeTreeCache&) = delete;
+
+  // Table used by type parsers.
+  static TypeTreeCache& Global();
+
+  // Returns tree parsed from 'blob' in 'endian' order, or one which was parsed
+  // from the same key before. Blob is copied, so the tree outlives its source.
+  std::expected<Tree, std::string> Intern(const Hash128& type_hash, std::uint32_t version,
+                                          platform::Endian endian, std::span<const char> blob);
+
+  // Count of trees in the table, some of them may be already released.
+  std::size_t size() const;
+  // Count of lookups which found a live tree.
+  std::uint64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  // Count of lookups which had to parse a tree.
+  std::uint64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Entry;
+
+  // Returns live entry equal to the key, drops released ones on the way.
+  std::shared_ptr<const Entry> Find(std::uint64_t digest, const Hash128& type_hash,
+                                    std::uint32_t version, platform::Endian endian,
+                                    std::span<const char> blob);
+  // Drops all released entries once the table has doubled since the last sweep.
+  void Sweep();
+
+  mutable std::mutex mutex_;
+  std::unordered_multimap<std::uint64_t, std::weak_ptr<const Entry>> entries_;
+  std::size_t swept_size_ = 0;
+  std::atomic<std::uint64_t> hits_ = 0;
+  std::atomic<std::uint64_t> misses_ = 0;
+};  // class TypeTreeCache
+
+}  // namespace unity
@@ -1,13 +1,34 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <optional>
+#include <functional>
 #include <span>
 
 #include <unity/flags.h>
 
+namespace archive {
+
+class LzmaStream;
+
+}  // namespace archive
+
 namespace unity {
 
+// Receives next part of unpacked data. Returned error stops unpacking.
+using UnpackSink = std::function<std::optional<std::string>(std::span<const char>)>;
+
 std::optional<std::string> Unpack(CompressionType type, std::span<const char> src, std::span<char> dst);
 
+// Unpacks range [begin; begin + size) of data with 'unpacked_size' total size and
+// passes it to 'sink' by parts. Parts are produced in 'scratch'. LZMA is decoded
+// incrementally, other compressions need whole unpacked data and allocate it if
+// 'scratch' is too small. LZMA is decoded by 'lzma' when it's given, so a caller
+// which streams several blocks keeps one decoder and dictionary for all of them.
+std::optional<std::string> UnpackStream(CompressionType type, std::span<const char> src, 
+                                        std::size_t unpacked_size, std::size_t begin, std::size_t size,
+                                        std::span<char> scratch, const UnpackSink& sink,
+                                        archive::LzmaStream* lzma = nullptr);
+
 }  // namespace unity
\ No newline at end of file
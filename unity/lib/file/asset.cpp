@@ -1,12 +1,197 @@
 #include "unity/file/asset.h"
 
+#include <algorithm>
+#include <bit>
+#include <mutex>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+# include <immintrin.h>
+#endif
+
 namespace unity {
 
 namespace file {
 
 std::span<const char> Asset::GetObject(std::uint32_t index) const {
-  auto& obj = objects[index];
-  return {(const char*)data + obj.offset, obj.size};
+  return {(const char*)data + objects.offsets()[index], objects.sizes()[index]};
+}
+
+static std::uint64_t HashPathId(std::int64_t path_id, std::uint64_t mask) {
+  // ids are often sequential or differ only in high bits: mix them all
+  auto value = static_cast<std::uint64_t>(path_id) * 0x9E3779B97F4A7C15ull;
+  return (value ^ (value >> 32)) & mask;
+}
+
+std::optional<std::uint32_t> Asset::FindObject(std::int64_t path_id) const {
+  auto path_ids = objects.path_ids();
+  std::call_once(index_->built, [this, path_ids] {
+    // at most half of slots are used, so probe sequences stay short
+    std::uint64_t capacity = std::bit_ceil(std::max<std::uint64_t>(2 * path_ids.size(), 8));
+    index_->mask = capacity - 1;
+    index_->slots = std::make_unique<std::uint32_t[]>(capacity);
+    for (std::uint32_t i = 0; i < path_ids.size(); ++i) {
+      auto pos = HashPathId(path_ids[i], index_->mask);
+      while (index_->slots[pos] != 0 && path_ids[index_->slots[pos] - 1] != path_ids[i])
+        pos = (pos + 1) & index_->mask;
+      if (index_->slots[pos] == 0) index_->slots[pos] = i + 1;
+    }
+  });
+
+  for (auto pos = HashPathId(path_id, index_->mask); index_->slots[pos] != 0; pos = (pos + 1) & index_->mask) {
+    std::uint32_t index = index_->slots[pos] - 1;
+    if (path_ids[index] == path_id) return index;
+  }
+  return std::nullopt;
+}
+
+Asset::ObjectTable::ObjectTable(std::uint32_t count)
+  : size_{count} {
+
+  constexpr std::size_t row_size = sizeof(*path_ids_) + sizeof(*offsets_) + sizeof(*sizes_) + 
+                                   sizeof(*type_ids_) + sizeof(*class_ids_) + sizeof(*destroyed_) + 
+                                   sizeof(*script_types_) + sizeof(*stripped_);
+  // 'new char[]' is aligned for any fundamental type
+  storage_ = std::make_unique_for_overwrite<char[]>(row_size * count);
+
+  char* next = storage_.get();
+  auto take = [&next, count]<typename T>(T*& column) {
+    column = reinterpret_cast<T*>(next);
+    next += sizeof(T) * count;
+  };
+  take(path_ids_);
+  take(offsets_);
+  take(sizes_);
+  take(type_ids_);
+  take(class_ids_);
+  take(destroyed_);
+  take(script_types_);
+  take(stripped_);
+}
+
+Asset::ObjectTable::ObjectTable(ObjectTable&& other) noexcept {
+  *this = std::move(other);
+}
+
+// columns point into 'storage_', so they're exchanged together with it
+Asset::ObjectTable& Asset::ObjectTable::operator=(ObjectTable&& other) noexcept {
+  std::swap(size_, other.size_);
+  std::swap(storage_, other.storage_);
+  std::swap(path_ids_, other.path_ids_);
+  std::swap(offsets_, other.offsets_);
+  std::swap(sizes_, other.sizes_);
+  std::swap(type_ids_, other.type_ids_);
+  std::swap(class_ids_, other.class_ids_);
+  std::swap(destroyed_, other.destroyed_);
+  std::swap(script_types_, other.script_types_);
+  std::swap(stripped_, other.stripped_);
+  return *this;
+}
+
+std::uint32_t Asset::ObjectTable::size() const {
+  return size_;
+}
+
+Asset::Object Asset::ObjectTable::operator[](std::uint32_t index) const {
+  Object ret;
+  ret.path_id = path_ids_[index];
+  ret.offset = offsets_[index];
+  ret.size = sizes_[index];
+  ret.type_id = type_ids_[index];
+  ret.class_id = class_ids_[index];
+  ret.destroyed = destroyed_[index];
+  ret.script_type = script_types_[index];
+  ret.stripped = stripped_[index];
+  return ret;
+}
+
+void Asset::ObjectTable::Set(std::uint32_t index, const Object& object) {
+  path_ids_[index] = object.path_id;
+  offsets_[index] = object.offset;
+  sizes_[index] = object.size;
+  type_ids_[index] = object.type_id;
+  class_ids_[index] = object.class_id;
+  destroyed_[index] = object.destroyed;
+  script_types_[index] = object.script_type;
+  stripped_[index] = object.stripped;
+}
+
+std::span<const std::int64_t> Asset::ObjectTable::path_ids() const {
+  return {path_ids_, size_};
+}
+
+std::span<const std::uint64_t> Asset::ObjectTable::offsets() const {
+  return {offsets_, size_};
+}
+
+std::span<const std::uint32_t> Asset::ObjectTable::sizes() const {
+  return {sizes_, size_};
+}
+
+std::span<const std::uint32_t> Asset::ObjectTable::type_ids() const {
+  return {type_ids_, size_};
+}
+
+std::span<const ClassID> Asset::ObjectTable::class_ids() const {
+  return {class_ids_, size_};
+}
+
+// Calls 'fn(base, mask)' for groups of up to 8 objects starting at 'base',
+// where bit 'i' of 'mask' is set when object 'base + i' matches.
+template<typename Fn>
+void Asset::ObjectTable::ForEachMatch(const ObjectFilter& filter, Fn&& fn) const {
+  auto matches = [&](std::uint32_t i) {
+    return (!filter.class_id || class_ids_[i] == *filter.class_id) &&
+           (sizes_[i] >= filter.min_size) && (sizes_[i] <= filter.max_size);
+  };
+
+  std::uint32_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  // SSE2 has only signed compares: flipping the sign bit keeps the order
+  const __m128i bias = _mm_set1_epi32(INT32_MIN);
+  const __m128i min_size = _mm_set1_epi32(static_cast<std::int32_t>(filter.min_size ^ 0x80000000u));
+  const __m128i max_size = _mm_set1_epi32(static_cast<std::int32_t>(filter.max_size ^ 0x80000000u));
+  const __m128i class_id = _mm_set1_epi32(filter.class_id ? static_cast<std::int32_t>(*filter.class_id) : 0);
+  const __m128i any_class = filter.class_id ? _mm_setzero_si128() : _mm_set1_epi32(-1);
+
+  auto match4 = [&](std::uint32_t at) {
+    auto classes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(class_ids_ + at));
+    auto sizes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sizes_ + at));
+    sizes = _mm_xor_si128(sizes, bias);
+    auto ret = _mm_or_si128(_mm_cmpeq_epi32(classes, class_id), any_class);
+    ret = _mm_andnot_si128(_mm_cmplt_epi32(sizes, min_size), ret);
+    ret = _mm_andnot_si128(_mm_cmpgt_epi32(sizes, max_size), ret);
+    return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(ret)));
+  };
+
+  for (; i + 8 <= size_; i += 8) {
+    std::uint32_t mask = match4(i) | (match4(i + 4) << 4);
+    if (mask != 0) fn(i, mask);
+  }
+#endif
+  for (; i < size_; i += 8) {
+    std::uint32_t mask = 0;
+    for (std::uint32_t j = 0; j < 8 && i + j < size_; ++j) 
+      mask |= static_cast<std::uint32_t>(matches(i + j)) << j;
+    if (mask != 0) fn(i, mask);
+  }
+}
+
+std::size_t Asset::ObjectTable::Select(const ObjectFilter& filter, std::vector<std::uint32_t>& out) const {
+  auto before = out.size();
+  ForEachMatch(filter, [&out](std::uint32_t base, std::uint32_t mask) {
+    for (; mask != 0; mask &= mask - 1) 
+      out.push_back(base + std::countr_zero(mask));
+  });
+  return out.size() - before;
+}
+
+std::size_t Asset::ObjectTable::Count(const ObjectFilter& filter) const {
+  std::size_t ret = 0;
+  ForEachMatch(filter, [&ret](std::uint32_t, std::uint32_t mask) {
+    ret += std::popcount(mask);
+  });
+  return ret;
 }
 
 }  // namespace file
@@ -0,0 +1,67 @@
+#include "unity/file/block_cache.h"
+
+#include <utility>
+
+namespace unity {
+
+namespace file {
+
+BlockCache::BlockCache(std::size_t capacity)
+  : capacity_{capacity}
+  {}
+
+std::size_t BlockCache::KeyHash::operator()(const Key& key) const {
+  return std::hash<std::uint64_t>{}((key.bundle << 32) ^ (key.bundle >> 32) ^ key.block);
+}
+
+BlockCache::Data BlockCache::Find(std::uint64_t bundle, std::uint32_t block) {
+  std::lock_guard lock{mutex_};
+  auto it = index_.find(Key{bundle, block});
+  if (it == index_.end()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  order_.splice(order_.begin(), order_, it->second);
+  return it->second->data;
+}
+
+void BlockCache::Insert(std::uint64_t bundle, std::uint32_t block, Data data, std::size_t size) {
+  if (size > capacity_) return;
+
+  Key key{bundle, block};
+  std::lock_guard lock{mutex_};
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    // block was unpacked concurrently, keep the older copy
+    order_.splice(order_.begin(), order_, it->second);
+    return;
+  }
+
+  while (used_ + size > capacity_) {
+    auto& last = order_.back();
+    used_ -= last.size;
+    index_.erase(last.key);
+    order_.pop_back();
+  }
+
+  order_.push_front(Entry{key, std::move(data), size});
+  index_.emplace(key, order_.begin());
+  used_ += size;
+}
+
+void BlockCache::Clear() {
+  std::lock_guard lock{mutex_};
+  index_.clear();
+  order_.clear();
+  used_ = 0;
+}
+
+std::size_t BlockCache::used() const {
+  std::lock_guard lock{mutex_};
+  return used_;
+}
+
+}  // namespace file
+
+}  // namespace unity
@@ -1,7 +1,13 @@
 #include "unity/file/bundle.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <format>
+#include <vector>
 
+#include <archive/lzma_stream.h>
+#include <common/data_reader.h>
 #include <common/memory.h>
 
 namespace unity {
@@ -26,97 +32,282 @@ const Bundle::File& Bundle::first_file() {
   return *reinterpret_cast<const File*>(files_);
 }
 
-std::optional<std::string> Bundle::UnpackData(std::size_t offset, 
-                                              std::span<char> buffer) {
+std::span<const char> Bundle::block_info() const {
+  return {unpacked_info_.get(), header.unpacked_info_size};
+}
 
-  // first block
-  std::size_t packed_pos = 0;
-  std::size_t unpacked_pos = 0;
-  std::uint32_t block_idx = 0;
-  const Block* cur_block = reinterpret_cast<const Block*>(blocks_);
-  while ((block_idx < block_count) && (unpacked_pos + cur_block->unpacked_size <= offset)) {
-    packed_pos += cur_block->packed_size;
-    unpacked_pos += cur_block->unpacked_size;
-    ++block_idx;
-    cur_block = common::ByteOffset(cur_block, Block::size_of);
+std::optional<std::string> Bundle::ReadInfo(std::span<const char> packed_info) {
+  auto dst_size = header.unpacked_info_size;
+  // corrupted size only reserves address space, decoding fails early
+  unpacked_info_ = std::make_unique_for_overwrite<char[]>(dst_size);
+
+  auto compress = static_cast<CompressionType>(header.flags & ArchiveFlags::CompressionMask);
+  auto decomp_result = Unpack(compress, packed_info, std::span{unpacked_info_.get(), dst_size});
+  if (decomp_result) return decomp_result;
+
+  // read blocks
+
+  common::DataReader<std::span<const char>> reader{block_info()};
+  reader.position = 16;  // hash of uncompressed data
+  if (!reader.Need(4)) return "Block info is out of data bounds";
+  block_count = reader.template Read<platform::u32be>();
+  if (!reader.Need(block_count, Block::size_of)) return "Block table is out of data bounds";
+  blocks_ = reader.template ReadArray<char>(block_count * Block::size_of);
+  BuildBlockIndex();
+
+  // read files, 'File::next' relies on names being terminated
+
+  if (!reader.Need(4)) return "Block info is out of data bounds";
+  file_count = reader.template Read<platform::u32be>();
+  files_ = static_cast<const char*>(reader.current());
+  constexpr std::size_t file_head_size = offsetof(File, name_first);
+  if (!reader.Need(file_count, file_head_size + 1)) return "File table is out of data bounds";
+  for (std::uint32_t i = 0; i < file_count; ++i) {
+    if (!reader.Need(file_head_size)) return "File table is out of data bounds";
+    reader.position += file_head_size;
+    if (!reader.template TryReadNullTerm<char>()) return "File table is out of data bounds";
+  }
+  return std::nullopt;
+}
+
+std::expected<Bundle::Window, std::string> Bundle::LendPacked(std::size_t begin, std::size_t size) {
+  if (lend_) return lend_(begin, size);
+  return Window{{data_ + begin, size}, {}};
+}
+
+std::uint64_t Bundle::NextId() {
+  static std::atomic<std::uint64_t> next = 0;
+  return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Bundle::BuildBlockIndex() {
+  block_offsets_ = std::make_unique<BlockOffset[]>(block_count + 1);
+  BlockOffset cur{0, 0};
+  for (std::uint32_t i = 0; i < block_count; ++i) {
+    block_offsets_[i] = cur;
+    cur.packed += block(i).packed_size;
+    cur.unpacked += block(i).unpacked_size;
   }
+  block_offsets_[block_count] = cur;
+}
+
+std::uint32_t Bundle::FindBlock(std::size_t offset) const {
+  // first block which starts after 'offset', its predecessor contains it
+  auto begin = block_offsets_.get();
+  auto end = begin + block_count + 1;
+  auto next = std::upper_bound(begin, end, offset, [](std::size_t value, const BlockOffset& block) {
+    return value < block.unpacked;
+  });
+  if (next == end) return block_count;
+  return static_cast<std::uint32_t>(next - begin - 1);
+}
+
+template<typename Fn>
+std::optional<std::string> Bundle::ForEachPiece(std::size_t offset, 
+                                                std::span<char> buffer, 
+                                                Window& window,
+                                                Fn&& fn) {
+
+  std::uint32_t block_idx = FindBlock(offset);
   if (block_idx == block_count) return "Offset is too large";
+  if (offset + buffer.size() > block_offsets_[block_count].unpacked) return "Offset and/or size is too large";
 
-  // unpack right suffix of the first block
-  if (offset != unpacked_pos) {
-    std::size_t begin_offset = offset - unpacked_pos;
-    std::size_t used_size = std::min(cur_block->unpacked_size - begin_offset, buffer.size());
-
-    std::unique_ptr<char[]> mem;
-    std::span<char> mem_span;
-    // don't create new buffer and reorder stuff in a given one when possible
-    if (buffer.size() < cur_block->unpacked_size) {
-      mem = std::make_unique<char[]>(cur_block->unpacked_size);
-      mem_span = {mem.get(), cur_block->unpacked_size};
-    } else {
-      mem_span = buffer.subspan(0, cur_block->unpacked_size);
-    }
+  // packed data of all covered blocks is taken at once
+  std::uint32_t last_idx = buffer.empty() ? block_idx : FindBlock(offset + buffer.size() - 1);
+  std::size_t window_pos = block_offsets_[block_idx].packed;
+  auto lent = LendPacked(window_pos, block_offsets_[last_idx + 1].packed - window_pos);
+  if (!lent) return std::move(lent.error());
+  window = *std::move(lent);
 
-    // unpack block
-    auto unpack_err = Unpack(
-      cur_block->compression(), 
-      {data_ + packed_pos, cur_block->packed_size},
-      mem_span
-    );
-    if (unpack_err) return unpack_err;
+  std::size_t packed_pos = window_pos;
+  std::size_t unpacked_pos = block_offsets_[block_idx].unpacked;
+  const Block* cur_block = &block(block_idx);
 
-    // keep only needed part
-    common::CopyTo(
-      common::AsConst(mem_span.subspan(begin_offset, used_size)),
-      buffer.subspan(0, used_size)
-    );
+  // first block may be covered partially, all next ones start from 0
+  std::size_t begin = offset - unpacked_pos;
+  while (!buffer.empty()) {
+    if (block_idx == block_count) return "Offset and/or size is too large";
 
-    // move to the next, full, block
+    std::size_t used_size = std::min(cur_block->unpacked_size - begin, buffer.size());
+    auto src = window.data.subspan(packed_pos - window_pos, cur_block->packed_size);
+    auto err = fn(Piece{block_idx, cur_block, src, begin, buffer.subspan(0, used_size)}, buffer);
+    if (err) return err;
+
+    // move to the next block
     buffer = buffer.subspan(used_size);
+    begin = 0;
     packed_pos += cur_block->packed_size;
-    unpacked_pos += cur_block->unpacked_size;
     ++block_idx;
     cur_block = common::ByteOffset(cur_block, Block::size_of);
   }
+  return std::nullopt;
+}
 
-  // unpack full blocks
-  while ((block_idx < block_count) && (buffer.size() >= cur_block->unpacked_size)) {
-    auto unpack_err = Unpack(
-      cur_block->compression(), 
-      {data_ + packed_pos, cur_block->packed_size},
-      buffer.subspan(0, cur_block->unpacked_size)
-    );
-    if (unpack_err) return unpack_err;
+std::optional<std::string> Bundle::UnpackPiece(const Piece& piece, std::span<char> scratch) {
+  std::size_t unpacked_size = piece.block->unpacked_size;
+  std::span<const char> src = piece.src;
 
-    // move to the next, full, block
-    buffer = buffer.subspan(cur_block->unpacked_size);
-    packed_pos += cur_block->packed_size;
-    unpacked_pos += cur_block->unpacked_size;
-    ++block_idx;
-    cur_block = common::ByteOffset(cur_block, Block::size_of);
+  // whole block is needed, unpack it in place
+  if (piece.dst.size() == unpacked_size) 
+    return Unpack(piece.block->compression(), src, piece.dst);
+
+  // partially read blocks are usually shared by neighbour files
+  if (cache_ != nullptr) {
+    if (auto cached = cache_->Find(id_, piece.index)) {
+      common::CopyTo(
+        std::span<const char>{cached.get() + piece.begin, piece.dst.size()},
+        piece.dst
+      );
+      return std::nullopt;
+    }
   }
-  
-  // unpack prefix of the last block 
-  if (!buffer.empty()) {
-    std::unique_ptr<char[]> mem = std::make_unique<char[]>(cur_block->unpacked_size);
-    std::span<char> mem_span = {mem.get(), cur_block->unpacked_size};
-
-    auto unpack_err = Unpack(
-      cur_block->compression(), 
-      {data_ + packed_pos, cur_block->packed_size},
-      mem_span
-    );
-    if (unpack_err) return unpack_err;
 
-    // keep only needed part
-    common::CopyTo(
-      common::AsConst(mem_span.subspan(0, buffer.size())),
-      buffer
-    );
+  std::unique_ptr<char[]> mem;
+  std::shared_ptr<char[]> shared;
+  std::span<char> mem_span;
+  // don't create new buffer and reorder stuff in a given one when possible
+  if (cache_ != nullptr) {
+    shared = std::make_shared_for_overwrite<char[]>(unpacked_size);
+    mem_span = {shared.get(), unpacked_size};
+  } else if (scratch.size() < unpacked_size) {
+    mem = std::make_unique<char[]>(unpacked_size);
+    mem_span = {mem.get(), unpacked_size};
+  } else {
+    mem_span = scratch.subspan(0, unpacked_size);
+  }
 
-    if (block_idx == block_count) return "Offset and/or size is too large";
+  auto unpack_err = Unpack(piece.block->compression(), src, mem_span);
+  if (unpack_err) return unpack_err;
+
+  // keep only needed part
+  common::CopyTo(
+    common::AsConst(mem_span.subspan(piece.begin, piece.dst.size())),
+    piece.dst
+  );
+  if (shared) cache_->Insert(id_, piece.index, std::move(shared), unpacked_size);
+  return std::nullopt;
+}
+
+std::optional<std::string> Bundle::UnpackData(std::size_t offset, 
+                                              std::span<char> buffer) {
+
+  // the rest of 'buffer' is not filled yet and can be used as scratch memory
+  Window window;
+  return ForEachPiece(offset, buffer, window, [this](const Piece& piece, std::span<char> rest) {
+    return UnpackPiece(piece, rest);
+  });
+}
+
+std::optional<std::string> Bundle::UnpackData(std::size_t offset, 
+                                              std::span<char> buffer,
+                                              common::ThreadPool& pool) {
+
+  std::vector<Piece> pieces;
+  Window window;
+  auto plan_err = ForEachPiece(offset, buffer, window, [&pieces](const Piece& piece, std::span<char>) {
+    pieces.push_back(piece);
+    return std::optional<std::string>{};
+  });
+  if (plan_err) return plan_err;
+
+  // pieces don't overlap, so tasks may write into 'buffer' concurrently
+  std::vector<std::optional<std::string>> errors(pieces.size());
+  // blocks after the first failed one are skipped, 
+  // so the reported error is the same as in serial version
+  std::atomic<std::size_t> first_failed = pieces.size();
+  {
+    common::TaskGroup group{pool};
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+      group.Run([this, &pieces, &errors, &first_failed, i] {
+        if (i > first_failed.load(std::memory_order_relaxed)) return;
+        errors[i] = UnpackPiece(pieces[i], pieces[i].dst);
+        if (!errors[i]) return;
+        auto failed = first_failed.load(std::memory_order_relaxed);
+        while (i < failed && !first_failed.compare_exchange_weak(failed, i)) {}
+      });
+    }
+    group.Wait();
   }
 
+  for (auto& err : errors) 
+    if (err) return std::move(err);
+  return std::nullopt;
+}
+
+std::optional<std::span<const char>> Bundle::ViewData(std::size_t offset, std::size_t size) {
+  if (lend_) return std::nullopt;
+
+  std::uint32_t first = FindBlock(offset);
+  if (first == block_count) return std::nullopt;
+  if (offset + size > block_offsets_[block_count].unpacked) return std::nullopt;
+
+  // packed and unpacked data of uncompressed blocks are the same
+  for (auto i = first; (i < block_count) && (block_offsets_[i].unpacked < offset + size); ++i) {
+    auto& cur = block(i);
+    if (cur.compression() != CompressionType::None) return std::nullopt;
+    if (cur.packed_size != cur.unpacked_size) return std::nullopt;
+  }
+
+  auto& start = block_offsets_[first];
+  return std::span<const char>{data_ + start.packed + (offset - start.unpacked), size};
+}
+
+std::expected<Bundle::Window, std::string> Bundle::PackedData(std::size_t offset, std::size_t size) {
+  std::uint32_t first = FindBlock(offset);
+  if (first == block_count) return std::unexpected("Offset is too large");
+  if (offset + size > block_offsets_[block_count].unpacked) return std::unexpected("Offset and/or size is too large");
+
+  auto begin = block_offsets_[first].packed;
+  if (size == 0) return LendPacked(begin, 0);
+
+  std::uint32_t last = FindBlock(offset + size - 1);
+  return LendPacked(begin, block_offsets_[last + 1].packed - begin);
+}
+
+std::expected<std::span<const char>, std::string> Bundle::ReadData(std::size_t offset, 
+                                                                   std::size_t size,
+                                                                   std::unique_ptr<char[]>& storage) {
+
+  if (auto view = ViewData(offset, size)) return *view;
+
+  storage = std::make_unique_for_overwrite<char[]>(size);
+  std::span<char> buffer{storage.get(), size};
+  auto err = UnpackData(offset, buffer);
+  if (err) return std::unexpected(*std::move(err));
+  return common::AsConst(buffer);
+}
+
+std::optional<std::string> Bundle::StreamData(std::size_t offset, 
+                                              std::size_t size,
+                                              std::span<char> scratch, 
+                                              const UnpackSink& sink) {
+
+  if (offset + size > block_offsets_[block_count].unpacked) return "Offset and/or size is too large";
+  if (size == 0) return std::nullopt;
+
+  // LZMA blocks of the range share one decoder, which keeps its dictionary
+  // between them; it's owned by this call, so sinks may stream again
+  std::optional<archive::LzmaStream> lzma;
+
+  std::uint32_t block_idx = FindBlock(offset);
+  std::size_t begin = offset - block_offsets_[block_idx].unpacked;
+  while (size != 0) {
+    auto& cur = block(block_idx);
+    std::size_t used_size = std::min<std::size_t>(cur.unpacked_size - begin, size);
+    // windowed source keeps only the current block mapped
+    auto window = LendPacked(block_offsets_[block_idx].packed, cur.packed_size);
+    if (!window) return std::move(window.error());
+    if (cur.compression() == CompressionType::LZMA && !lzma) lzma.emplace();
+    auto err = UnpackStream(
+      cur.compression(), window->data,
+      cur.unpacked_size, begin, used_size, scratch, sink, lzma ? &*lzma : nullptr
+    );
+    if (err) return err;
+
+    size -= used_size;
+    begin = 0;
+    ++block_idx;
+  }
   return std::nullopt;
 }
 
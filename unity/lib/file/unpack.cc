@@ -1,9 +1,12 @@
 #include "unity/unpack.h"
 
 #include <cstring>
+#include <algorithm>
+#include <memory>
 #include <format>
 
 #include <archive/unpack.h>
+#include <archive/lzma_stream.h>
 #include <common/memory.h>
 
 namespace unity {
@@ -44,4 +47,77 @@ std::optional<std::string> Unpack(CompressionType type,
   return std::nullopt;
 }
 
-} // namespace unity
\ No newline at end of file
+static std::optional<std::string> StreamLZMA(std::span<const char> src, std::size_t unpacked_size,
+                                             std::size_t begin, std::size_t size,
+                                             std::span<char> scratch, const UnpackSink& sink,
+                                             archive::LzmaStream* lzma) {
+
+  constexpr auto err_fmt = "LZMA streaming decompression failed, returning {}";
+  constexpr std::size_t props_size = 5;
+
+  std::optional<archive::LzmaStream> local;
+  auto& stream = lzma ? *lzma : local.emplace();
+  auto code = stream.Init(src.subspan(0, std::min(src.size(), props_size)), unpacked_size);
+  if (code != 0) return std::format(err_fmt, code);
+  src = src.subspan(std::min(src.size(), props_size));
+
+  // output after the range is not needed
+  while (stream.produced() < begin + size) {
+    std::uint64_t chunk_begin = stream.produced();
+    auto dst = scratch.subspan(0, std::min<std::uint64_t>(scratch.size(), begin + size - chunk_begin));
+    std::span<char> left = dst;
+    code = stream.Decode(src, left);
+    if (code != 0) return std::format(err_fmt, code);
+
+    std::span<const char> chunk = dst.subspan(0, dst.size() - left.size());
+    if (chunk.empty()) return std::format(err_fmt, archive::ErrorUnpackNotAll);
+
+    // skip output before the range
+    if (chunk_begin + chunk.size() <= begin) continue;
+    if (chunk_begin < begin) chunk = chunk.subspan(begin - chunk_begin);
+    if (auto err = sink(chunk)) return err;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> UnpackStream(CompressionType type, 
+                                        std::span<const char> src, 
+                                        std::size_t unpacked_size, 
+                                        std::size_t begin, 
+                                        std::size_t size,
+                                        std::span<char> scratch, 
+                                        const UnpackSink& sink,
+                                        archive::LzmaStream* lzma) {
+
+  if (begin + size > unpacked_size) {
+    constexpr auto fmt = "Requested range [{}; {}) is out of unpacked size {}";
+    return std::format(fmt, begin, begin + size, unpacked_size);
+  }
+  if (size == 0) return std::nullopt;
+
+  switch (type) {
+   case CompressionType::None:
+    if (src.size() != unpacked_size) {
+      constexpr auto fmt = "Buffer size mismatch: Packed({}) != unpacked({})";
+      return std::format(fmt, src.size(), unpacked_size);
+    }
+    // already unpacked, no need to copy
+    return sink(src.subspan(begin, size));
+   case CompressionType::LZMA:
+    if (scratch.empty()) return "No scratch memory for LZMA streaming";
+    return StreamLZMA(src, unpacked_size, begin, size, scratch, sink, lzma);
+   default:
+    break;
+  }
+
+  std::unique_ptr<char[]> mem;
+  if (scratch.size() < unpacked_size) {
+    mem = std::make_unique_for_overwrite<char[]>(unpacked_size);
+    scratch = {mem.get(), unpacked_size};
+  }
+  auto whole = scratch.subspan(0, unpacked_size);
+  if (auto err = Unpack(type, src, whole)) return err;
+  return sink(common::AsConst(whole.subspan(begin, size)));
+}
+
+} // namespace unity
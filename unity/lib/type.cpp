@@ -1,8 +1,15 @@
 #include <unity/type.h>
 
+#include <cassert>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include <unity/type/plan.h>
+
 namespace unity {
 
-static const auto kCommonString = 
+static constexpr char kCommonString[] = 
   "AABB\0"
   "AnimationClip\0"
   "AnimationCurve\0"
@@ -113,11 +120,140 @@ static const auto kCommonString =
   "FileSize\0"
   "Hash128";
 
-const char* TypeTree::GetString(std::uint32_t offset) const {
-  if (offset & 0x80000000) {
-    return kCommonString + (offset & 0x7FFFFFFF);
+std::size_t TypeTree::NodeSize(std::uint32_t version) {
+  return (version > 19) ? 32 : 24;
+}
+
+const TypeTree* Type::tree() const {
+  auto state = state_.value.load(std::memory_order_acquire);
+  if (state == kParsed) return tree_.get();
+
+  if (state == kPending && state_.value.compare_exchange_strong(state, kParsing, std::memory_order_acquire)) {
+    auto tree = TypeTreeCache::Global().Intern(old_type_hash, pending_version_, 
+                                               pending_endian_, pending_blob_);
+    if (tree) tree_ = *std::move(tree);
+    state_.value.store(kParsed, std::memory_order_release);
+    state_.value.notify_all();
+    return tree_.get();
+  }
+
+  // another thread parses it
+  while (state != kParsed) {
+    state_.value.wait(state, std::memory_order_acquire);
+    state = state_.value.load(std::memory_order_acquire);
+  }
+  return tree_.get();
+}
+
+struct TypeTree::PlanSlot {
+  std::once_flag compiled;
+  std::optional<type::ReadPlan> plan;
+};  // struct TypeTree::PlanSlot
+
+TypeTree::TypeTree() = default;
+TypeTree::~TypeTree() = default;
+
+TypeTree::TypeTree(TypeTree&& other) noexcept {
+  *this = std::move(other);
+}
+
+// columns point into 'storage_', so they're exchanged together with it
+TypeTree& TypeTree::operator=(TypeTree&& other) noexcept {
+  std::swap(node_count, other.node_count);
+  std::swap(strings, other.strings);
+  std::swap(storage_, other.storage_);
+  std::swap(ref_type_hashes_, other.ref_type_hashes_);
+  std::swap(sizes_, other.sizes_);
+  std::swap(meta_flags_, other.meta_flags_);
+  std::swap(type_ids_, other.type_ids_);
+  std::swap(name_ids_, other.name_ids_);
+  std::swap(versions_, other.versions_);
+  std::swap(shapes_, other.shapes_);
+  std::swap(plan_, other.plan_);
+  return *this;
+}
+
+const type::ReadPlan& TypeTree::plan() const {
+  assert(plan_);
+  std::call_once(plan_->compiled, [this] { plan_->plan = type::ReadPlan::Compile(*this); });
+  return *plan_->plan;
+}
+
+void TypeTree::Allocate(std::uint32_t count, bool with_ref_hashes) {
+  std::size_t row_size = sizeof(*sizes_) + sizeof(*meta_flags_) + sizeof(*type_ids_) +
+                         sizeof(*name_ids_) + sizeof(*versions_) + sizeof(*shapes_);
+  if (with_ref_hashes) row_size += sizeof(*ref_type_hashes_);
+  // 'new char[]' is aligned for any fundamental type
+  storage_ = std::make_unique_for_overwrite<char[]>(row_size * count);
+  node_count = count;
+  plan_ = std::make_unique<PlanSlot>();
+
+  char* next = storage_.get();
+  auto take = [&next, count]<typename T>(T*& column) {
+    column = reinterpret_cast<T*>(next);
+    next += sizeof(T) * count;
+  };
+  if (with_ref_hashes) {
+    take(ref_type_hashes_);
+  } else {
+    ref_type_hashes_ = nullptr;
+  }
+  take(sizes_);
+  take(meta_flags_);
+  take(type_ids_);
+  take(name_ids_);
+  take(versions_);
+  take(shapes_);
+}
+
+std::optional<std::string> TypeTree::ResolveIds(std::uint32_t string_size) {
+  // terminated table makes any offset within it a valid string
+  if (string_size != 0 && strings[string_size - 1] != '\0') return "TypeTree strings aren't terminated";
+
+  auto resolve = [this, string_size](std::uint32_t& id) {
+    if (!HasString(id, string_size)) return false;
+    // common offsets are usually at string starts, so they're ids already
+    std::uint32_t offset = id & ~kCommonBit;
+    if ((id & kCommonBit) && (offset == 0 || kCommonString[offset - 1] == '\0')) return true;
+    auto common = CommonId(GetString(id));
+    if (common != kNoId) id = common;
+    return true;
+  };
+  for (std::uint32_t i = 0; i < node_count; ++i) {
+    if (!resolve(type_ids_[i]) || !resolve(name_ids_[i]))
+      return "TypeTree string offset is out of bounds";
+  }
+  return std::nullopt;
+}
+
+std::uint32_t TypeTree::CommonId(std::string_view value) {
+  static const auto ids = [] {
+    std::unordered_map<std::string_view, std::uint32_t> ret;
+    for (std::uint32_t offset = 0; offset < sizeof(kCommonString);) {
+      std::string_view name{kCommonString + offset};
+      ret.emplace(name, kCommonBit | offset);
+      offset += name.size() + 1;
+    }
+    return ret;
+  }();
+
+  auto it = ids.find(value);
+  return (it != ids.end()) ? it->second : kNoId;
+}
+
+bool TypeTree::HasString(std::uint32_t offset, std::uint32_t string_size) {
+  if (offset & kCommonBit) {
+    return (offset & ~kCommonBit) < sizeof(kCommonString);
+  } else {
+    return offset < string_size;
+  }
+}
+
+const char* TypeTree::GetString(std::uint32_t id) const {
+  if (id & kCommonBit) {
+    return kCommonString + (id & ~kCommonBit);
   } else {
-    return strings + offset;
+    return strings + id;
   }
 }
 
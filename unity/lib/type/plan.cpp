@@ -0,0 +1,607 @@
+#include <unity/type/plan.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include <common/data_reader.h>
+
+namespace unity {
+
+namespace type {
+
+class ReadPlan::Compiler {
+ public:
+  Compiler(const TypeTree& tree, ReadPlan& plan)
+    : tree_{tree}
+    , plan_{plan}
+    {}
+
+  // Emits ops which produce a single value of node 'index'.
+  std::optional<std::string> Single(std::uint32_t index);
+  // Emits ops which produce values of fields at 'paths' from the root node.
+  std::optional<std::string> Project(std::span<const std::string_view> paths);
+
+ private:
+  // Requested field of projection.
+  struct Target {
+    std::uint32_t node;
+    std::uint32_t path;
+  };  // struct Target
+
+  // Index of the node after subtree of node 'index'.
+  std::uint32_t SkipSubtree(std::uint32_t index) const;
+  // Whether 'index' is a direct child of node at 'level'.
+  bool IsChild(std::uint32_t index, std::uint8_t level) const;
+  // Returns direct child of node 'index' with 'name', or 'node_count'.
+  std::uint32_t FindChild(std::uint32_t index, std::string_view name) const;
+  // Whether node is an array, which has size and data children.
+  bool IsArray(const TypeTree::Cursor& node) const;
+  // Whether node 'index' only wraps an array, like 'vector' or 'string'.
+  bool IsWrapper(std::uint32_t index) const;
+  // Returns size of subtree 'index' if it's known without data: no arrays
+  // and no alignment inside. Node itself can still be aligned.
+  std::optional<std::uint32_t> FixedSize(std::uint32_t index) const;
+  // Returns the least count of bytes which node 'index' takes in data,
+  // may be 0 for empty structs.
+  std::uint32_t MinSize(std::uint32_t index) const;
+  std::optional<std::string> CheckScalar(const TypeTree::Cursor& node, Scalar type) const;
+  std::optional<std::string> CheckArray(std::uint32_t index) const;
+
+  // Emits ops for fields of object at 'index', sets their 'count'.
+  std::optional<std::string> Fields(std::uint32_t index, std::uint32_t& count);
+  // Emits ops for 'Array' node at 'index' which produce value of 'node'.
+  std::optional<std::string> Array(std::uint32_t index, std::uint32_t node);
+
+  // Emits ops for fields of node 'index' until all targets are found.
+  std::optional<std::string> Walk(std::uint32_t index);
+  // Emits ops which move past node 'index' without producing values.
+  std::optional<std::string> SkipNode(std::uint32_t index);
+  // Same for 'Array' node.
+  std::optional<std::string> SkipArray(std::uint32_t index);
+
+  void Emit(Op op);
+  void EmitAlign() { Emit({.code = Op::Code::Align}); }
+  // Adjacent skips are merged into one.
+  void EmitSkip(std::uint32_t bytes);
+  // Body of a loop ends, skips after it can't be merged into it.
+  void CloseBody(std::size_t loop);
+
+  const TypeTree& tree_;
+  ReadPlan& plan_;
+  // 'Skip' op which can be extended
+  std::optional<std::size_t> skip_;
+  // targets in tree order, 'next_' is the first one not found yet
+  std::vector<Target> targets_;
+  std::size_t next_ = 0;
+};  // class ReadPlan::Compiler
+
+void ReadPlan::Compiler::Emit(Op op) {
+  skip_.reset();
+  plan_.ops_.push_back(op);
+}
+
+void ReadPlan::Compiler::EmitSkip(std::uint32_t bytes) {
+  if (skip_ && plan_.ops_[*skip_].bytes <= UINT32_MAX - bytes) {
+    plan_.ops_[*skip_].bytes += bytes;
+    return;
+  }
+  Emit({.code = Op::Code::Skip, .bytes = bytes});
+  skip_ = plan_.ops_.size() - 1;
+}
+
+void ReadPlan::Compiler::CloseBody(std::size_t loop) {
+  skip_.reset();
+  plan_.ops_[loop].body = static_cast<std::uint32_t>(plan_.ops_.size() - loop - 1);
+}
+
+std::uint32_t ReadPlan::Compiler::SkipSubtree(std::uint32_t index) const {
+  auto level = tree_.node(index).level();
+  std::uint32_t next = index + 1;
+  while (next < tree_.node_count && tree_.node(next).level() > level) ++next;
+  return next;
+}
+
+bool ReadPlan::Compiler::IsChild(std::uint32_t index, std::uint8_t level) const {
+  return index < tree_.node_count && tree_.node(index).level() == level + 1;
+}
+
+std::uint32_t ReadPlan::Compiler::FindChild(std::uint32_t index, std::string_view name) const {
+  auto level = tree_.node(index).level();
+  auto end = SkipSubtree(index);
+  for (std::uint32_t child = index + 1; child < end; child = SkipSubtree(child)) {
+    if (IsChild(child, level) && tree_.node(child).name() == name) return child;
+  }
+  return tree_.node_count;
+}
+
+bool ReadPlan::Compiler::IsArray(const TypeTree::Cursor& node) const {
+  static const std::uint32_t typeless_id = TypeTree::CommonId("TypelessData");
+  static const std::uint32_t array_id = TypeTree::CommonId("Array");
+  return (node.flags() & 1) || node.HasType(array_id, "Array") || node.HasType(typeless_id, "TypelessData");
+}
+
+bool ReadPlan::Compiler::IsWrapper(std::uint32_t index) const {
+  return IsChild(index + 1, tree_.node(index).level()) && (tree_.node(index + 1).flags() & 1)
+      && SkipSubtree(index + 1) == SkipSubtree(index);
+}
+
+std::optional<std::uint32_t> ReadPlan::Compiler::FixedSize(std::uint32_t index) const {
+  auto node = tree_.node(index);
+  if (node.size() < 0 || IsArray(node)) return std::nullopt;
+  auto end = SkipSubtree(index);
+  for (std::uint32_t inner = index + 1; inner < end; ++inner) {
+    auto inner_node = tree_.node(inner);
+    if (inner_node.aligned() || IsArray(inner_node)) return std::nullopt;
+  }
+  return node.size();
+}
+
+std::uint32_t ReadPlan::Compiler::MinSize(std::uint32_t index) const {
+  auto node = tree_.node(index);
+  auto scalar = ScalarOf(node);
+  if (scalar != Scalar::None) return static_cast<std::uint32_t>(SizeOf(scalar));
+  // just the size of an empty array
+  if (IsArray(node)) return 4;
+
+  std::uint64_t size = 0;
+  auto end = SkipSubtree(index);
+  for (std::uint32_t field = index + 1; field < end; field = SkipSubtree(field)) {
+    if (IsChild(field, node.level())) size += MinSize(field);
+  }
+  return static_cast<std::uint32_t>(std::min<std::uint64_t>(size, UINT32_MAX));
+}
+
+std::optional<std::string> ReadPlan::Compiler::CheckArray(std::uint32_t index) const {
+  auto array = tree_.node(index);
+  if (!IsChild(index + 1, array.level()) || !IsChild(index + 2, array.level())
+      || index + 2 >= SkipSubtree(index))
+    return std::string{"Array '"} + array.name() + "' has no size or data";
+
+  auto size = tree_.node(index + 1);
+  if (ScalarOf(size) != Scalar::SInt32 || size.size() != 4)
+    return std::string{"Size of array '"} + array.name() + "' isn't 'int'";
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::CheckScalar(const TypeTree::Cursor& node, Scalar type) const {
+  if (node.size() != static_cast<std::int32_t>(SizeOf(type)))
+    return std::string{"Size of '"} + node.name() + "' doesn't match its type";
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::Single(std::uint32_t index) {
+  auto node = tree_.node(index);
+  auto scalar = ScalarOf(node);
+  if (scalar != Scalar::None) {
+    if (auto err = CheckScalar(node, scalar)) return err;
+    plan_.fields_.push_back({index, 0, scalar});
+    Emit({.code = Op::Code::Fields, .count = 1,
+          .first = static_cast<std::uint32_t>(plan_.fields_.size() - 1),
+          .bytes = static_cast<std::uint32_t>(SizeOf(scalar))});
+  } else if (IsArray(node)) {
+    // array node aligns itself
+    return Array(index, index);
+  } else if (IsWrapper(index)) {
+    // containers like 'vector' or 'string' only wrap their array
+    if (auto err = Array(index + 1, index)) return err;
+  } else {
+    std::size_t object = plan_.ops_.size();
+    Emit({.code = Op::Code::Object, .node = index});
+    std::uint32_t count;
+    if (auto err = Fields(index, count)) return err;
+    plan_.ops_[object].count = count;
+    CloseBody(object);
+  }
+
+  if (node.aligned()) EmitAlign();
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::Fields(std::uint32_t index, std::uint32_t& count) {
+  auto level = tree_.node(index).level();
+  auto end = SkipSubtree(index);
+  // index of 'Fields' op which is still extended by adjacent primitives
+  std::optional<std::size_t> run;
+
+  count = 0;
+  for (std::uint32_t field = index + 1; field < end; field = SkipSubtree(field)) {
+    if (!IsChild(field, level)) continue;
+    ++count;
+
+    auto node = tree_.node(field);
+    auto scalar = ScalarOf(node);
+    if (scalar == Scalar::None) {
+      run.reset();
+      if (auto err = Single(field)) return err;
+      continue;
+    }
+
+    if (auto err = CheckScalar(node, scalar)) return err;
+    if (!run) {
+      run = plan_.ops_.size();
+      Emit({.code = Op::Code::Fields, .first = static_cast<std::uint32_t>(plan_.fields_.size())});
+    }
+    auto& op = plan_.ops_[*run];
+    plan_.fields_.push_back({field, op.bytes, scalar});
+    ++op.count;
+    op.bytes += SizeOf(scalar);
+    if (node.aligned()) {
+      run.reset();
+      EmitAlign();
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::Array(std::uint32_t index, std::uint32_t node) {
+  static const std::uint32_t typeless_id = TypeTree::CommonId("TypelessData");
+
+  if (auto err = CheckArray(index)) return err;
+  auto array = tree_.node(index);
+  auto size = tree_.node(index + 1);
+
+  std::uint32_t element = index + 2;
+  auto element_node = tree_.node(element);
+  auto scalar = ScalarOf(element_node);
+  if (scalar != Scalar::None && !element_node.aligned() && !CheckScalar(element_node, scalar)) {
+    auto kind = Value::Kind::Scalars;
+    if (scalar == Scalar::Char) kind = Value::Kind::String;
+    if (array.HasType(typeless_id, "TypelessData")) kind = Value::Kind::Bytes;
+    Emit({.code = Op::Code::Scalars, .type = scalar, .size_aligned = size.aligned(), .kind = kind,
+          .node = node, .array = index, .bytes = static_cast<std::uint32_t>(SizeOf(scalar))});
+  } else {
+    std::size_t loop = plan_.ops_.size();
+    Emit({.code = Op::Code::Array, .size_aligned = size.aligned(), .node = node, .array = index,
+          .bytes = MinSize(element)});
+    if (auto err = Single(element)) return err;
+    CloseBody(loop);
+  }
+
+  if (array.aligned()) EmitAlign();
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::Project(std::span<const std::string_view> paths) {
+  for (std::uint32_t path = 0; path < paths.size(); ++path) {
+    std::uint32_t index = 0;
+    std::string_view rest = paths[path];
+    while (true) {
+      auto dot = rest.find('.');
+      index = FindChild(index, rest.substr(0, dot));
+      if (index == tree_.node_count) return "Field '" + std::string{paths[path]} + "' isn't found";
+      if (dot == std::string_view::npos) break;
+      if (IsArray(tree_.node(index)) || IsWrapper(index))
+        return "Field '" + std::string{paths[path]} + "' is inside of an array";
+      rest.remove_prefix(dot + 1);
+    }
+    targets_.push_back({index, path});
+  }
+
+  std::sort(targets_.begin(), targets_.end(), [](auto& a, auto& b) { return a.node < b.node; });
+  for (std::size_t i = 1; i < targets_.size(); ++i) {
+    if (targets_[i].node < SkipSubtree(targets_[i - 1].node))
+      return "Field '" + std::string{paths[targets_[i].path]} + "' overlaps with another one";
+  }
+  if (auto err = Walk(0)) return err;
+  if (next_ < targets_.size()) return "Field '" + std::string{paths[targets_[next_].path]} + "' isn't reachable";
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::Walk(std::uint32_t index) {
+  auto level = tree_.node(index).level();
+  auto end = SkipSubtree(index);
+  for (std::uint32_t field = index + 1; field < end && next_ < targets_.size(); field = SkipSubtree(field)) {
+    if (!IsChild(field, level)) continue;
+
+    auto& target = targets_[next_];
+    if (target.node == field) {
+      Emit({.code = Op::Code::Target, .first = target.path});
+      ++next_;
+      if (auto err = Single(field)) return err;
+    } else if (target.node < SkipSubtree(field)) {
+      if (auto err = Walk(field)) return err;
+      // nothing is read after the last target, even padding
+      if (next_ < targets_.size() && tree_.node(field).aligned()) EmitAlign();
+    } else {
+      if (auto err = SkipNode(field)) return err;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::SkipNode(std::uint32_t index) {
+  auto node = tree_.node(index);
+  auto scalar = ScalarOf(node);
+  if (scalar != Scalar::None) {
+    if (auto err = CheckScalar(node, scalar)) return err;
+    EmitSkip(static_cast<std::uint32_t>(SizeOf(scalar)));
+  } else if (IsArray(node)) {
+    // array node aligns itself
+    return SkipArray(index);
+  } else if (IsWrapper(index)) {
+    if (auto err = SkipArray(index + 1)) return err;
+  } else if (auto size = FixedSize(index)) {
+    EmitSkip(*size);
+  } else {
+    auto end = SkipSubtree(index);
+    for (std::uint32_t field = index + 1; field < end; field = SkipSubtree(field)) {
+      if (!IsChild(field, node.level())) continue;
+      if (auto err = SkipNode(field)) return err;
+    }
+  }
+
+  if (node.aligned()) EmitAlign();
+  return std::nullopt;
+}
+
+std::optional<std::string> ReadPlan::Compiler::SkipArray(std::uint32_t index) {
+  if (auto err = CheckArray(index)) return err;
+  auto array = tree_.node(index);
+  auto size = tree_.node(index + 1);
+
+  std::uint32_t element = index + 2;
+  auto element_size = FixedSize(element);
+  if (element_size && !tree_.node(element).aligned()) {
+    Emit({.code = Op::Code::SkipArray, .size_aligned = size.aligned(), .array = index, .bytes = *element_size});
+  } else {
+    std::size_t loop = plan_.ops_.size();
+    Emit({.code = Op::Code::Repeat, .size_aligned = size.aligned(), .array = index, .bytes = MinSize(element)});
+    if (auto err = SkipNode(element)) return err;
+    CloseBody(loop);
+  }
+
+  if (array.aligned()) EmitAlign();
+  return std::nullopt;
+}
+
+template<platform::Endian E>
+class ReadPlan::Executor {
+ public:
+  Executor(const ReadPlan& plan, const TypeTree& tree, std::span<const char> data,
+           std::pmr::memory_resource& arena, Value* targets)
+    : plan_{plan}
+    , tree_{tree}
+    , reader_{data}
+    , arena_{arena}
+    , targets_{targets}
+    {}
+
+  // Runs ops [op; end), produced values are stored from 'out' on.
+  std::optional<std::string> Run(const Op* op, const Op* end, Value* out);
+
+ private:
+  template<typename T>
+  static T Load(const char* at) {
+    return *reinterpret_cast<const platform::ByteOrdered<T, E>*>(at);
+  }
+  static void Load(const Field& field, const char* run, Value& out);
+
+  // Reads size of array 'op', with its alignment.
+  std::optional<std::string> ReadSize(const Op& op, std::int32_t& count);
+  // Checks that 'count' elements of array 'op' can be in data.
+  std::optional<std::string> CheckCount(const Op& op, std::int32_t count);
+
+  const ReadPlan& plan_;
+  const TypeTree& tree_;
+  common::DataReader<std::span<const char>> reader_;
+  std::pmr::memory_resource& arena_;
+  // fields of projection
+  Value* targets_;
+  // elements of empty structs take no data, so only this many are decoded
+  std::size_t empty_budget_ = std::size_t{1} << 20;
+};  // class ReadPlan::Executor
+
+static constexpr char kOutOfBounds[] = "Object data is out of bounds";
+
+template<platform::Endian E>
+void ReadPlan::Executor<E>::Load(const Field& field, const char* run, Value& out) {
+  const char* at = run + field.offset;
+  out.node = field.node;
+  out.element = Scalar::None;
+  out.size = 0;
+  switch (field.type) {
+    case Scalar::Bool: out.kind = Value::Kind::Bool; out.b = Load<std::uint8_t>(at); break;
+    case Scalar::Char: out.kind = Value::Kind::Int; out.i = Load<char>(at); break;
+    case Scalar::SInt8: out.kind = Value::Kind::Int; out.i = Load<std::int8_t>(at); break;
+    case Scalar::UInt8: out.kind = Value::Kind::UInt; out.u = Load<std::uint8_t>(at); break;
+    case Scalar::SInt16: out.kind = Value::Kind::Int; out.i = Load<std::int16_t>(at); break;
+    case Scalar::UInt16: out.kind = Value::Kind::UInt; out.u = Load<std::uint16_t>(at); break;
+    case Scalar::SInt32: out.kind = Value::Kind::Int; out.i = Load<std::int32_t>(at); break;
+    case Scalar::UInt32: out.kind = Value::Kind::UInt; out.u = Load<std::uint32_t>(at); break;
+    case Scalar::SInt64: out.kind = Value::Kind::Int; out.i = Load<std::int64_t>(at); break;
+    case Scalar::UInt64: out.kind = Value::Kind::UInt; out.u = Load<std::uint64_t>(at); break;
+    case Scalar::Float: out.kind = Value::Kind::Float; out.f = Load<float>(at); break;
+    case Scalar::Double: out.kind = Value::Kind::Float; out.f = Load<double>(at); break;
+    case Scalar::None: break;
+  }
+}
+
+template<platform::Endian E>
+std::optional<std::string> ReadPlan::Executor<E>::ReadSize(const Op& op, std::int32_t& count) {
+  if (!reader_.Need(4)) return kOutOfBounds;
+  count = reader_.template Read<platform::ByteOrdered<std::int32_t, E>>();
+  if (count < 0) return std::string{"Size of array '"} + tree_.node(op.array).name() + "' is negative";
+  if (op.size_aligned) reader_.AlignTo(4);
+  return std::nullopt;
+}
+
+template<platform::Endian E>
+std::optional<std::string> ReadPlan::Executor<E>::CheckCount(const Op& op, std::int32_t count) {
+  if (op.bytes != 0) {
+    if (!reader_.Need(count, op.bytes)) return kOutOfBounds;
+    return std::nullopt;
+  }
+  if (static_cast<std::size_t>(count) > empty_budget_)
+    return std::string{"Array '"} + tree_.node(op.array).name() + "' has too many empty elements";
+  empty_budget_ -= count;
+  return std::nullopt;
+}
+
+template<typename T>
+static void ConvertScalars(const char* src, void* dst, std::size_t count, platform::Endian order) {
+  platform::ConvertSpan<T>({reinterpret_cast<const platform::RuntimeOrder<T>*>(src), count},
+                           {static_cast<T*>(dst), count}, order);
+}
+
+template<platform::Endian E>
+std::optional<std::string> ReadPlan::Executor<E>::Run(const Op* op, const Op* end, Value* out) {
+  while (op < end) {
+    switch (op->code) {
+      case Op::Code::Fields: {
+        // a single check covers the whole run
+        if (!reader_.Need(op->bytes)) return kOutOfBounds;
+        auto run = reader_.template ReadArray<char>(op->bytes);
+        for (std::uint32_t i = 0; i < op->count; ++i)
+          Load(plan_.fields_[op->first + i], run, *out++);
+        ++op;
+        break;
+      }
+      case Op::Code::Align: {
+        reader_.AlignTo(4);
+        ++op;
+        break;
+      }
+      case Op::Code::Object: {
+        auto children = static_cast<Value*>(arena_.allocate(sizeof(Value) * op->count, alignof(Value)));
+        if (auto err = Run(op + 1, op + 1 + op->body, children)) return err;
+        Value& value = *out++;
+        value.kind = Value::Kind::Object;
+        value.element = Scalar::None;
+        value.node = op->node;
+        value.size = op->count;
+        value.children = children;
+        op += 1 + op->body;
+        break;
+      }
+      case Op::Code::Array: {
+        std::int32_t count;
+        if (auto err = ReadSize(*op, count)) return err;
+        // elements take at least 'bytes' each, so 'count' can't be huge
+        if (auto err = CheckCount(*op, count)) return err;
+        auto children = static_cast<Value*>(arena_.allocate(sizeof(Value) * count, alignof(Value)));
+        for (std::int32_t i = 0; i < count; ++i) {
+          if (auto err = Run(op + 1, op + 1 + op->body, children + i)) return err;
+        }
+        Value& value = *out++;
+        value.kind = Value::Kind::Array;
+        value.element = Scalar::None;
+        value.node = op->node;
+        value.size = count;
+        value.children = children;
+        op += 1 + op->body;
+        break;
+      }
+      case Op::Code::Scalars: {
+        std::int32_t count;
+        if (auto err = ReadSize(*op, count)) return err;
+        if (auto err = CheckCount(*op, count)) return err;
+        auto src = reader_.template ReadArray<char>(count * op->bytes);
+        Value& value = *out++;
+        value.kind = op->kind;
+        value.element = (op->kind == Value::Kind::Scalars) ? op->type : Scalar::None;
+        value.node = op->node;
+        value.size = count;
+        if (op->kind != Value::Kind::Scalars || op->bytes == 1) {
+          // single bytes are already native, so they stay in place
+          value.data = src;
+        } else {
+          void* dst = arena_.allocate(count * op->bytes, op->bytes);
+          switch (op->bytes) {
+            case 2: ConvertScalars<std::uint16_t>(src, dst, count, E); break;
+            case 4: ConvertScalars<std::uint32_t>(src, dst, count, E); break;
+            case 8: ConvertScalars<std::uint64_t>(src, dst, count, E); break;
+          }
+          value.data = dst;
+        }
+        ++op;
+        break;
+      }
+      case Op::Code::Skip: {
+        if (!reader_.Need(op->bytes)) return kOutOfBounds;
+        reader_.position += op->bytes;
+        ++op;
+        break;
+      }
+      case Op::Code::SkipArray: {
+        std::int32_t count;
+        if (auto err = ReadSize(*op, count)) return err;
+        if (auto err = CheckCount(*op, count)) return err;
+        reader_.position += count * std::size_t{op->bytes};
+        ++op;
+        break;
+      }
+      case Op::Code::Repeat: {
+        std::int32_t count;
+        if (auto err = ReadSize(*op, count)) return err;
+        if (auto err = CheckCount(*op, count)) return err;
+        for (std::int32_t i = 0; i < count; ++i) {
+          if (auto err = Run(op + 1, op + 1 + op->body, out)) return err;
+        }
+        op += 1 + op->body;
+        break;
+      }
+      case Op::Code::Target: {
+        out = targets_ + op->first;
+        ++op;
+        break;
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+ReadPlan ReadPlan::Compile(const TypeTree& tree) {
+  ReadPlan plan;
+  if (tree.node_count == 0) {
+    plan.error_ = "Type tree is empty";
+    return plan;
+  }
+  Compiler compiler{tree, plan};
+  plan.error_ = compiler.Single(0);
+  return plan;
+}
+
+ReadPlan ReadPlan::Project(const TypeTree& tree, std::span<const std::string_view> paths) {
+  ReadPlan plan;
+  if (tree.node_count == 0) {
+    plan.error_ = "Type tree is empty";
+    return plan;
+  }
+  if (paths.empty()) {
+    plan.error_ = "No fields to project";
+    return plan;
+  }
+  plan.targets_ = static_cast<std::uint32_t>(paths.size());
+  Compiler compiler{tree, plan};
+  plan.error_ = compiler.Project(paths);
+  return plan;
+}
+
+std::optional<std::string> ReadPlan::Execute(const TypeTree& tree, std::span<const char> data,
+                                             platform::Endian order, std::pmr::memory_resource& arena,
+                                             Value& out) const {
+  if (error_) return error_;
+  const Op* begin = ops_.data();
+  const Op* end = begin + ops_.size();
+  Value* targets = nullptr;
+  if (targets_ != 0) {
+    targets = static_cast<Value*>(arena.allocate(sizeof(Value) * targets_, alignof(Value)));
+    out.kind = Value::Kind::Object;
+    out.element = Scalar::None;
+    out.node = 0;
+    out.size = targets_;
+    out.children = targets;
+  }
+
+  // byte order is checked once, everything else is decoded for a known one
+  if (order == platform::Endian::B) {
+    return Executor<platform::Endian::B>{*this, tree, data, arena, targets}.Run(begin, end, &out);
+  } else {
+    return Executor<platform::Endian::L>{*this, tree, data, arena, targets}.Run(begin, end, &out);
+  }
+}
+
+}  // namespace type
+
+}  // namespace unity
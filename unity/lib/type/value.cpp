@@ -0,0 +1,117 @@
+#include <unity/type/value.h>
+
+#include <array>
+#include <utility>
+
+#include <unity/type/plan.h>
+
+namespace unity {
+
+namespace type {
+
+namespace {
+
+struct ScalarName {
+  std::string_view name;
+  Scalar type;
+};  // struct ScalarName
+
+constexpr ScalarName kScalarNames[] = {
+  {"bool", Scalar::Bool},
+  {"char", Scalar::Char},
+  {"SInt8", Scalar::SInt8},
+  {"UInt8", Scalar::UInt8},
+  {"SInt16", Scalar::SInt16},
+  {"short", Scalar::SInt16},
+  {"UInt16", Scalar::UInt16},
+  {"unsigned short", Scalar::UInt16},
+  {"int", Scalar::SInt32},
+  {"SInt32", Scalar::SInt32},
+  {"unsigned int", Scalar::UInt32},
+  {"UInt32", Scalar::UInt32},
+  {"long long", Scalar::SInt64},
+  {"SInt64", Scalar::SInt64},
+  {"unsigned long long", Scalar::UInt64},
+  {"UInt64", Scalar::UInt64},
+  {"FileSize", Scalar::UInt64},
+  {"float", Scalar::Float},
+  {"double", Scalar::Double},
+};
+
+}  // namespace
+
+Scalar ScalarOf(const TypeTree::Cursor& node) {
+  static const auto ids = [] {
+    std::array<std::uint32_t, std::size(kScalarNames)> ret;
+    for (std::size_t i = 0; i < ret.size(); ++i) ret[i] = TypeTree::CommonId(kScalarNames[i].name);
+    return ret;
+  }();
+
+  auto id = node.type_id();
+  if (id & TypeTree::kCommonBit) {
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      if (ids[i] == id) return kScalarNames[i].type;
+    }
+    return Scalar::None;
+  }
+  std::string_view type = node.type();
+  for (auto& scalar : kScalarNames) {
+    if (scalar.name == type) return scalar.type;
+  }
+  return Scalar::None;
+}
+
+std::size_t SizeOf(Scalar type) {
+  switch (type) {
+    case Scalar::None: return 0;
+    case Scalar::Bool: case Scalar::Char: case Scalar::SInt8: case Scalar::UInt8: return 1;
+    case Scalar::SInt16: case Scalar::UInt16: return 2;
+    case Scalar::SInt32: case Scalar::UInt32: case Scalar::Float: return 4;
+    case Scalar::SInt64: case Scalar::UInt64: case Scalar::Double: return 8;
+  }
+  return 0;
+}
+
+ValueTree::ValueTree(const TypeTree& tree, std::size_t initial_size)
+  : tree_{&tree}
+  , arena_{std::make_unique<std::pmr::monotonic_buffer_resource>(initial_size)}
+  {}
+
+std::expected<ValueTree, std::string> ValueTree::Decode(const TypeTree& tree, std::span<const char> data,
+                                                        platform::Endian order) {
+  return Decode(tree.plan(), tree, data, order);
+}
+
+std::expected<ValueTree, std::string> ValueTree::Decode(const ReadPlan& plan, const TypeTree& tree,
+                                                        std::span<const char> data, platform::Endian order) {
+  if (plan.error()) return std::unexpected(*plan.error());
+
+  // converted arrays take about the size of data, fields are small;
+  // projections mostly take a few fields, the arena grows if they don't
+  ValueTree ret{tree, plan.projection() ? 256 : data.size() + 1024};
+  auto root = static_cast<Value*>(ret.arena_->allocate(sizeof(Value), alignof(Value)));
+  auto err = plan.Execute(tree, data, order, *ret.arena_, *root);
+  if (err) return std::unexpected(*std::move(err));
+  ret.root_ = root;
+  return std::move(ret);
+}
+
+const char* ValueTree::name(const Value& value) const {
+  return tree_->node(value.node).name();
+}
+
+const char* ValueTree::type(const Value& value) const {
+  return tree_->node(value.node).type();
+}
+
+const Value* ValueTree::Find(const Value& object, std::string_view name) const {
+  if (object.kind != Value::Kind::Object) return nullptr;
+  for (auto& field : object.items()) {
+    if (this->name(field) == name) return &field;
+  }
+  return nullptr;
+}
+
+}  // namespace type
+
+}  // namespace unity
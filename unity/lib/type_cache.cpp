@@ -0,0 +1,100 @@
+#include <unity/type_cache.h>
+
+#include <cstring>
+#include <string_view>
+
+#include <unity/type.h>
+
+namespace unity {
+
+struct TypeTreeCache::Entry {
+  Hash128 type_hash;
+  std::uint32_t version;
+  platform::Endian endian;
+  std::size_t blob_size;
+  // tree strings point here
+  std::unique_ptr<char[]> blob;
+  TypeTree tree;
+
+  bool Matches(const Hash128& other_hash, std::uint32_t other_version,
+               platform::Endian other_endian, std::span<const char> other_blob) const {
+    return version == other_version && endian == other_endian && blob_size == other_blob.size()
+        && std::memcmp(type_hash.data, other_hash.data, sizeof(type_hash.data)) == 0
+        && std::memcmp(blob.get(), other_blob.data(), blob_size) == 0;
+  }
+};  // struct TypeTreeCache::Entry
+
+TypeTreeCache& TypeTreeCache::Global() {
+  static TypeTreeCache cache;
+  return cache;
+}
+
+std::expected<TypeTreeCache::Tree, std::string> TypeTreeCache::Intern(
+    const Hash128& type_hash, std::uint32_t version, platform::Endian endian, std::span<const char> blob) {
+  std::string_view hash_bytes{reinterpret_cast<const char*>(type_hash.data), sizeof(type_hash.data)};
+  std::uint64_t digest = std::hash<std::string_view>{}({blob.data(), blob.size()});
+  digest ^= std::hash<std::string_view>{}(hash_bytes) + 0x9E3779B97F4A7C15ull + (digest << 6) + (digest >> 2);
+  digest ^= (std::uint64_t{version} << 8) | static_cast<std::uint64_t>(endian);
+
+  {
+    std::lock_guard lock{mutex_};
+    if (auto entry = Find(digest, type_hash, version, endian, blob)) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      return Tree{entry, &entry->tree};
+    }
+  }
+  misses_.fetch_add(1, std::memory_order_relaxed);
+
+  // parsed without the lock, racing threads keep the first inserted tree
+  auto entry = std::make_shared<Entry>();
+  entry->type_hash = type_hash;
+  entry->version = version;
+  entry->endian = endian;
+  entry->blob_size = blob.size();
+  entry->blob = std::make_unique_for_overwrite<char[]>(blob.size());
+  std::memcpy(entry->blob.get(), blob.data(), blob.size());
+
+  common::DataReader<std::span<const char>> reader{std::span<const char>{entry->blob.get(), blob.size()}};
+  auto err = (endian == platform::Endian::B)
+           ? entry->tree.ReadBlob<platform::Endian::B>(reader, version)
+           : entry->tree.ReadBlob<platform::Endian::L>(reader, version);
+  if (err) return std::unexpected(*std::move(err));
+
+  std::lock_guard lock{mutex_};
+  if (auto existing = Find(digest, type_hash, version, endian, blob))
+    return Tree{existing, &existing->tree};
+  std::shared_ptr<const Entry> shared = std::move(entry);
+  entries_.emplace(digest, shared);
+  Sweep();
+  return Tree{shared, &shared->tree};
+}
+
+std::shared_ptr<const TypeTreeCache::Entry> TypeTreeCache::Find(
+    std::uint64_t digest, const Hash128& type_hash, std::uint32_t version,
+    platform::Endian endian, std::span<const char> blob) {
+  auto [it, end] = entries_.equal_range(digest);
+  while (it != end) {
+    auto entry = it->second.lock();
+    if (!entry) {
+      it = entries_.erase(it);
+    } else if (entry->Matches(type_hash, version, endian, blob)) {
+      return entry;
+    } else {
+      ++it;
+    }
+  }
+  return nullptr;
+}
+
+void TypeTreeCache::Sweep() {
+  if (entries_.size() < 2 * swept_size_ + 64) return;
+  std::erase_if(entries_, [](const auto& item) { return item.second.expired(); });
+  swept_size_ = entries_.size();
+}
+
+std::size_t TypeTreeCache::size() const {
+  std::lock_guard lock{mutex_};
+  return entries_.size();
+}
+
+}  // namespace unity